@@ -0,0 +1,58 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Engine.h"
+
+namespace MzingaCpp
+{
+// Runs a list of UHP commands against every game string of an input (one per
+// line), spread across threads that each own an Engine, and writes each game's
+// output in input order
+class BatchRunner
+{
+  public:
+    BatchRunner(int numThreads, std::vector<std::string> const &commands);
+
+    bool TryLoadOpeningBook(std::string const &path);
+
+    bool Run(std::istream &input, std::ostream &output);
+
+  private:
+    // A game in the window of games between the oldest unwritten one and the newest read one
+    struct BatchSlot
+    {
+        std::string GameString;
+        std::string Result;
+        bool Done = false;
+    };
+
+    void RunGames(Engine &engine, std::string &engineOutput);
+
+    int m_numThreads;
+    std::vector<std::string> m_commands;
+    std::string m_bookPath;
+
+    // Game i lives in slot i % BatchWindowSize, so reading stalls only when the oldest game in the window
+    // isn't done yet, and memory use doesn't grow with the input
+    std::vector<BatchSlot> m_slots;
+    size_t m_numGamesRead = 0;
+    size_t m_nextGame = 0;
+    size_t m_numGamesWritten = 0;
+    bool m_inputDone = false;
+
+    std::mutex m_mutex;
+    std::condition_variable m_gameReady;
+    std::condition_variable m_gameDone;
+};
+} // namespace MzingaCpp
+
+#endif
@@ -4,8 +4,10 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "Constants.h"
@@ -13,7 +15,6 @@
 #include "Move.h"
 #include "MoveSet.h"
 #include "Position.h"
-#include "PositionSet.h"
 
 namespace MzingaCpp
 {
@@ -22,85 +23,155 @@ class Board
   public:
     Board(GameType gameType);
 
-    BoardState GetBoardState();
-    int GetCurrentTurn();
+    // Per-thread move generation caches are keyed by board id, so boards are never copied
+    Board(Board const &) = delete;
+    Board &operator=(Board const &) = delete;
 
-    std::string GetGameString();
-    std::shared_ptr<MoveSet> GetValidMoves();
+    GameType GetGameType() const;
+    BoardState GetBoardState() const;
+    Color GetCurrentColor() const;
+    int GetCurrentTurn() const;
+    Move GetLastMove() const;
+
+    uint64_t GetZobristKey() const;
+
+    std::string GetGameString() const;
+    std::shared_ptr<MoveSet> GetValidMoves() const;
+    long CountValidMoves() const;
+
+    // Same as checking GetValidMoves, but only looks at where the move's piece can go
+    bool IsValidMove(Move const &move) const;
 
     bool TryPlayMove(Move const &move, std::string moveString);
     bool TryUndoLastMove();
 
-    bool TryGetMoveString(Move const &move, std::string &result);
-    bool TryParseMove(std::string moveString, Move &result, std::string &resultString);
+    bool TryGetMoveString(Move const &move, std::string &result) const;
+    void GetMoveStrings(MoveSet const &moves, std::string &result) const;
+    bool TryParseMove(std::string_view moveString, Move &result, std::string &resultString) const;
+    bool TryGetMove(PieceName const &pieceName, PieceName const &targetPieceName, Direction const &direction,
+                    Move &result) const;
 
-    long CalculatePerft(int depth);
+    void TrustedPlay(Move const &move, std::string const &moveString);
 
-    std::shared_ptr<Board> Clone();
+    long CalculatePerft(int depth);
 
-  private:
-    void GetValidMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet);
-    void CalculateValidPlacements();
-
-    void GetValidQueenBeeMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet);
-    void GetValidSpiderMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet);
-    void GetValidBeetleMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet);
-    void GetValidGrasshopperMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet);
-    void GetValidSoldierAntMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet);
-    void GetValidMosquitoMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet,
-                               bool const &specialAbilityOnly);
-    void GetValidLadybugMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet);
-    void GetValidPillbugBasicMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet);
-    void GetValidPillbugSpecialMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet);
+    std::shared_ptr<Board> Clone() const;
 
-    void GetValidSlides(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet, int fixedRange);
-    void GetValidSlides(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet, Position const &startingPosition,
-                        Position const &lastPosition, Position const &currentPosition);
-    void GetValidSlides(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet, Position const &startingPosition,
-                        Position const &lastPosition, Position const &currentPosition, int remainingSlides);
+    static bool TryParseGameString(std::string_view gameString, std::shared_ptr<Board> &result);
 
-    void TrustedPlay(Move const &move);
+    Position GetPosition(PieceName const &pieceName) const;
 
-    bool PlacingPieceInOrder(PieceName const &pieceName);
+    bool PieceInPlay(PieceName const &pieceName) const;
+    bool PieceIsOnTop(PieceName const &pieceName) const;
 
-    Position GetPosition(PieceName const &pieceName);
-    void SetPosition(PieceName const &pieceName, Position const &position);
+    bool CanMoveWithoutBreakingHive(PieceName const &pieceName) const;
 
-    PieceName GetPieceAt(Position const &position);
-    PieceName GetPieceAt(Position const &position, Direction const &direction);
-    PieceName GetPieceOnTopAt(Position const &position);
-    bool HasPieceAt(Position const &position);
-    bool HasPieceAt(Position const &position, Direction const &direction);
+    int CountNeighbors(PieceName const &pieceName) const;
 
-    bool PieceInHand(PieceName const &pieceName);
-    bool PieceInPlay(PieceName const &pieceName);
+  private:
+    // Move generators specialized on which expansion bugs are in the game, picked once per Board
+    typedef void (Board::*GetValidMovesFunction)(std::shared_ptr<MoveSet> moveSet) const;
+    typedef long (Board::*CountValidMovesFunction)() const;
+    typedef bool (Board::*IsValidMoveFunction)(Move const &move) const;
+
+    template <bool MosquitoEnabled, bool LadybugEnabled, bool PillbugEnabled> void SetMoveGenerators();
+
+    template <bool MosquitoEnabled, bool LadybugEnabled, bool PillbugEnabled>
+    void GetEnabledValidMoves(std::shared_ptr<MoveSet> moveSet) const;
+    template <bool MosquitoEnabled, bool LadybugEnabled, bool PillbugEnabled>
+    void GetEnabledValidMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const;
+    template <bool MosquitoEnabled, bool LadybugEnabled, bool PillbugEnabled> long CountEnabledValidMoves() const;
+    template <bool MosquitoEnabled, bool LadybugEnabled, bool PillbugEnabled>
+    bool IsEnabledValidMove(Move const &move) const;
+
+    void CalculateValidPlacements() const;
+
+    void GetValidQueenBeeMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const;
+    void GetValidSpiderMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const;
+    void GetValidBeetleMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const;
+    void GetValidGrasshopperMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const;
+    void GetValidSoldierAntMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const;
+    void GetValidMosquitoMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet,
+                               bool const &specialAbilityOnly) const;
+    void GetValidLadybugMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const;
+    void GetValidPillbugBasicMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const;
+    void GetValidPillbugSpecialMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const;
+
+    void GetValidSlides(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet, int fixedRange) const;
+    void GetValidSlides(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet, int startingCell, int lastCell,
+                        int currentCell, int remainingSlides) const;
+
+    void FloodFillSlides(int startingCell) const;
+    void FindSpiderSlides(int startingCell) const;
+    void BeginSlides(int vacatedCell) const;
+    void EndSlides() const;
+    bool TryGetBeetleMove(int cell, int stack, Direction const &direction, int &destinationStack,
+                          int liftedCell = -1) const;
+    void FindLadybugMoves(PieceName const &pieceName) const;
+    bool TryGetGrasshopperMove(int cell, Direction const &direction, int &destinationCell) const;
+
+    bool CanMovePiece(PieceName const &pieceName) const;
+    int GetNeighborBugTypes(int cell) const;
+    bool CanThrowPieces(PieceName const &pieceName) const;
+    int CountValidPlacements() const;
+
+    void ResetDestinations() const;
+    bool AddDestination(int cell) const;
+    bool TryAppendMoveString(Move const &move, std::string &result) const;
+    void AddValidPlacementDestinations() const;
+    template <bool MosquitoEnabled, bool LadybugEnabled, bool PillbugEnabled>
+    void AddEnabledMovementDestinations(PieceName const &pieceName, BugType const &bugType) const;
+    void AddValidSlideDestinations(PieceName const &pieceName, int fixedRange) const;
+    void AddValidSlideDestinations(int startingCell, int lastCell, int currentCell, int remainingSlides) const;
+    void AddValidSpiderDestinations(PieceName const &pieceName) const;
+    void AddValidSoldierAntDestinations(PieceName const &pieceName) const;
+    void AddValidBeetleDestinations(PieceName const &pieceName) const;
+    void AddValidGrasshopperDestinations(PieceName const &pieceName) const;
+    void AddValidLadybugDestinations(PieceName const &pieceName) const;
+    void AddValidThrowDestinations(PieceName const &throwerName, Direction const &direction) const;
+
+    bool PlacingPieceInOrder(PieceName const &pieceName) const;
 
-    bool PieceIsOnTop(PieceName const &pieceName);
+    void SetPosition(PieceName const &pieceName, Position const &position);
+    void SetPosition(PieceName const &pieceName, int cell, int stack);
 
-    bool CanMoveWithoutBreakingHive(PieceName const &pieceName);
+    PieceName GetPieceAt(int cell, int stack) const;
+    PieceName GetPieceOnTopAt(int cell) const;
+    int GetHeight(int cell, int liftedCell) const;
+    bool HasPieceAt(int cell) const;
+    bool HasPieceAt(int cell, int stack) const;
 
-    bool IsOneHive();
+    bool PieceInHand(PieceName const &pieceName) const;
 
-    int CountNeighbors(PieceName const &pieceName);
+    bool IsOneHive(PieceName const &ignoredPiece) const;
 
     void ResetState();
     void ResetCaches();
 
     GameType m_gameType = GameType::Base;
+    uint64_t m_boardId;
+    GetValidMovesFunction m_getValidMoves = nullptr;
+    CountValidMovesFunction m_countValidMoves = nullptr;
+    IsValidMoveFunction m_isValidMove = nullptr;
     BoardState m_boardState = BoardState::NotStarted;
     Color m_currentColor = Color::White;
     int m_currentTurn = 0;
 
     PieceName m_lastPieceMoved = PieceName::INVALID;
 
-    Position m_piecePositions[(int)PieceName::NumPieceNames];
-    PieceName m_pieceGrid[BoardSize][BoardSize][BoardStackSize];
+    uint64_t m_zobristKey = 0;
+
+    // Bumped whenever the position changes, so per-thread caches can tell if they're for this position
+    uint64_t m_positionVersion = 0;
+
+    // Pieces in hand have a stack of -1
+    int m_pieceCells[(int)PieceName::NumPieceNames];
+    int m_pieceStacks[(int)PieceName::NumPieceNames];
+    PieceName m_pieceGrid[BoardCellCount][BoardStackSize];
+    uint8_t m_cellHeights[BoardCellCount];
 
     std::vector<Move> m_moveHistory;
     std::vector<std::string> m_moveHistoryStr;
-
-    PositionSet m_cachedValidPlacements;
-    bool m_cachedValidPlacementsReady = false;
 };
 } // namespace MzingaCpp
 
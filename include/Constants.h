@@ -4,6 +4,7 @@
 #ifndef CONSTANTS_H
 #define CONSTANTS_H
 
+#include <cstdint>
 #include <string>
 
 namespace MzingaCpp
@@ -29,6 +30,8 @@ constexpr const char *CommandString_Undo = "undo";
 constexpr const char *CommandString_Options = "options";
 
 constexpr const char *CommandString_Perft = "perft";
+constexpr const char *CommandString_Stats = "stats";
+constexpr const char *CommandString_Trace = "trace";
 constexpr const char *CommandString_Exit = "exit";
 
 constexpr const char *ErrString = "err";
@@ -37,14 +40,63 @@ constexpr const char *ErrorMessage_NoGameInProgress = "No game in progress. Try
 constexpr const char *ErrorMessage_GameIsOver = "The game is over. Try 'newgame' to start a new game.";
 constexpr const char *ErrorMessage_UnableToUndo = "Unable to undo that many moves.";
 constexpr const char *ErrorMessage_Unknown = "An unknown error has occured.";
+constexpr const char *ErrorMessage_StatsDisabled = "Stats are disabled. Rebuild with MZINGACPP_STATS=ON to use them.";
+constexpr const char *ErrorMessage_TracingDisabled =
+    "Tracing is disabled. Rebuild with MZINGACPP_TRACING=ON to use it.";
+constexpr const char *ErrorMessage_UnableToWriteTrace = "Unable to write the trace file.";
+constexpr const char *ErrorMessage_ServerUnsupported = "Server mode is only supported on Linux.";
+constexpr const char *ErrorMessage_ProcessCommandsDisabled = "That command isn't available to server sessions.";
 
 constexpr const char *InvalidMoveString = "invalidmove";
 constexpr const char *InvalidMoveMessage_Generic = "Unable to play that move at this time.";
 
 constexpr const char *PassMoveString = "pass";
 
+// Longest possible move string, e.g. "wA1 -bA1"
+constexpr const int MaxMoveStringLength = 8;
+
+constexpr const char *BestMoveArg_Depth = "depth";
+constexpr const char *BestMoveArg_Time = "time";
+constexpr const char *BestMoveArg_Mate = "mate";
+
+constexpr const char *StatsArg_Reset = "reset";
+
+constexpr const char *TraceArg_Start = "start";
+constexpr const char *TraceArg_Stop = "stop";
+constexpr const char *TraceArg_Dump = "dump";
+
 constexpr const int BoardSize = 128;
 constexpr const int BoardStackSize = 8;
+constexpr const int BoardCellCount = BoardSize * BoardSize;
+
+constexpr const int MaxSearchPly = 64;
+constexpr const int DefaultMaxSearchDepth = 2;
+constexpr const int NumKillerMoves = 2;
+constexpr const int MaxMateSearchSeconds = 10;
+
+constexpr const char OpeningBookMagic[4] = {'M', 'Z', 'B', 'K'};
+constexpr const uint32_t OpeningBookVersion = 1;
+constexpr const int MaxOpeningBookTurns = 8;
+
+constexpr const size_t GameStringCacheSize = 16;
+
+constexpr const char GameRecordMagic[4] = {'M', 'Z', 'G', 'R'};
+constexpr const uint32_t GameRecordVersion = 1;
+
+constexpr const size_t BatchWindowSize = 1024;
+
+constexpr const size_t TrainingDataBufferSize = 4096;
+constexpr const int SelfPlayRandomTurns = 4;
+constexpr const int MaxSelfPlayTurns = 200;
+constexpr const char *DefaultBatchCommand = "bestmove";
+
+constexpr const size_t TraceBufferSize = 16384;
+
+constexpr const int ServerListenBacklog = 128;
+constexpr const int ServerMaxEvents = 64;
+constexpr const size_t ServerReadBufferSize = 4096;
+// Most unrun input buffered per session, which also limits how long a line can be
+constexpr const size_t ServerMaxInputLength = 65536;
 
 } // namespace MzingaCpp
 
@@ -8,46 +8,68 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 
 #include "Board.h"
+#include "GameAI.h"
+#include "GameStringCache.h"
+#include "OpeningBook.h"
+#include "Stats.h"
 
 namespace MzingaCpp
 {
 class Engine
 {
   public:
-    Engine(std::function<void(std::string)> writeLine);
+    Engine(std::function<void(std::string_view)> writeOutput);
 
     void Start();
 
-    void ReadLine(std::string line);
+    void ReadLine(std::string_view line);
+
+    bool TryLoadOpeningBook(std::string const &path);
 
     bool ExitRequested()
     {
         return m_exitRequested;
     }
 
+    // Rejects stats and trace, since their state is shared by every engine in the process
+    void DisableProcessCommands()
+    {
+        m_processCommandsEnabled = false;
+    }
+
   private:
-    void WriteLine(std::string line);
-    void WriteError(std::string message);
+    void WriteLine(std::string_view line);
+    void WriteError(std::string_view message);
     void WriteError();
+    void FlushOutput();
+    void WriteStats(StatCounts const &stats);
 
     void Info();
-    void NewGame(std::string args);
+    void NewGame(std::string_view args);
     void ValidMoves();
-    void BestMove();
-    void Play(std::string args);
+    void BestMove(std::string_view args);
+    void Play(std::string_view args);
     void Pass();
-    void Undo(std::string args);
+    void Undo(std::string_view args);
     void Options();
 
-    void Perft(std::string args);
+    void Perft(std::string_view args);
+    void Stats(std::string_view args);
+    void Trace(std::string_view args);
     void Exit();
 
-    std::function<void(std::string)> m_writeLine;
+    std::function<void(std::string_view)> m_writeOutput;
+    std::string m_outputBuffer;
     bool m_exitRequested = false;
+    bool m_processCommandsEnabled = true;
 
     std::shared_ptr<Board> m_board = nullptr;
+    std::shared_ptr<GameAI> m_gameAI = nullptr;
+    std::shared_ptr<OpeningBook> m_openingBook = nullptr;
+    std::shared_ptr<GameStringCache> m_gameStringCache = nullptr;
 };
 } // namespace MzingaCpp
 
@@ -4,7 +4,10 @@
 #ifndef ENUMS_H
 #define ENUMS_H
 
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace MzingaCpp
 {
@@ -15,6 +18,13 @@ enum class Color
     NumColors,
 };
 
+inline constexpr std::string_view ColorStrings[(int)Color::NumColors] = {"White", "Black"};
+
+constexpr std::string_view GetEnumStringView(Color const &value)
+{
+    return (unsigned)value < (unsigned)Color::NumColors ? ColorStrings[(int)value] : std::string_view();
+}
+
 std::string GetEnumString(Color const &value);
 
 enum class BoardState
@@ -26,6 +36,13 @@ enum class BoardState
     BlackWins,
 };
 
+inline constexpr std::string_view BoardStateStrings[] = {"NotStarted", "InProgress", "Draw", "WhiteWins", "BlackWins"};
+
+constexpr std::string_view GetEnumStringView(BoardState const &value)
+{
+    return (unsigned)value <= (unsigned)BoardState::BlackWins ? BoardStateStrings[(int)value] : std::string_view();
+}
+
 std::string GetEnumString(BoardState const &value);
 
 bool GameInProgress(BoardState const &value);
@@ -65,10 +82,40 @@ enum class PieceName
     NumPieceNames
 };
 
+constexpr const int NumPieceNamesPerColor = (int)PieceName::bQ;
+
+inline constexpr std::string_view PieceNameStrings[(int)PieceName::NumPieceNames] = {
+    "wQ", "wS1", "wS2", "wB1", "wB2", "wG1", "wG2", "wG3", "wA1", "wA2", "wA3", "wM", "wL", "wP",
+    "bQ", "bS1", "bS2", "bB1", "bB2", "bG1", "bG2", "bG3", "bA1", "bA2", "bA3", "bM", "bL", "bP",
+};
+
+constexpr std::string_view GetEnumStringView(PieceName const &value)
+{
+    return (unsigned)value < (unsigned)PieceName::NumPieceNames ? PieceNameStrings[(int)value] : std::string_view();
+}
+
 std::string GetEnumString(PieceName const &value);
-PieceName GetPieceNameValue(const char *str);
+PieceName GetPieceNameValue(std::string_view str);
 
-Color GetColor(PieceName const &value);
+// Builds a table indexed by PieceName from the given constexpr function of the piece
+template <typename T, typename Generator>
+constexpr std::array<T, (size_t)PieceName::NumPieceNames> MakePieceNameTable(Generator generator)
+{
+    std::array<T, (size_t)PieceName::NumPieceNames> table{};
+    for (int pn = 0; pn < (int)PieceName::NumPieceNames; pn++)
+    {
+        table[pn] = generator((PieceName)pn);
+    }
+    return table;
+}
+
+inline constexpr auto PieceNameColors = MakePieceNameTable<Color>(
+    [](PieceName pieceName) { return (int)pieceName < NumPieceNamesPerColor ? Color::White : Color::Black; });
+
+constexpr Color GetColor(PieceName const &value)
+{
+    return (unsigned)value < (unsigned)PieceName::NumPieceNames ? PieceNameColors[(int)value] : Color::NumColors;
+}
 
 enum class Direction
 {
@@ -82,8 +129,15 @@ enum class Direction
     Above = 6,
 };
 
-Direction LeftOf(Direction const &value);
-Direction RightOf(Direction const &value);
+constexpr Direction LeftOf(Direction const &value)
+{
+    return (Direction)(((int)value + (int)Direction::NumDirections - 1) % (int)Direction::NumDirections);
+}
+
+constexpr Direction RightOf(Direction const &value)
+{
+    return (Direction)(((int)value + 1) % (int)Direction::NumDirections);
+}
 
 enum class BugType
 {
@@ -99,7 +153,20 @@ enum class BugType
     NumBugTypes,
 };
 
-BugType GetBugType(PieceName const &value);
+// Indexed by the offset of a piece from its color's queen
+inline constexpr BugType ColorPieceBugTypes[NumPieceNamesPerColor] = {
+    BugType::QueenBee,    BugType::Spider,      BugType::Spider,      BugType::Beetle,     BugType::Beetle,
+    BugType::Grasshopper, BugType::Grasshopper, BugType::Grasshopper, BugType::SoldierAnt, BugType::SoldierAnt,
+    BugType::SoldierAnt,  BugType::Mosquito,    BugType::Ladybug,     BugType::Pillbug,
+};
+
+inline constexpr auto PieceNameBugTypes = MakePieceNameTable<BugType>(
+    [](PieceName pieceName) { return ColorPieceBugTypes[(int)pieceName % NumPieceNamesPerColor]; });
+
+constexpr BugType GetBugType(PieceName const &value)
+{
+    return (unsigned)value < (unsigned)PieceName::NumPieceNames ? PieceNameBugTypes[(int)value] : BugType::INVALID;
+}
 
 enum class GameType
 {
@@ -114,10 +181,58 @@ enum class GameType
     BaseMLP,
 };
 
+constexpr const int NumGameTypes = (int)GameType::BaseMLP + 1;
+
+inline constexpr std::string_view GameTypeStrings[NumGameTypes] = {
+    "Base", "Base+M", "Base+L", "Base+P", "Base+ML", "Base+MP", "Base+LP", "Base+MLP",
+};
+
+constexpr std::string_view GetEnumStringView(GameType const &value)
+{
+    return (unsigned)value < (unsigned)NumGameTypes ? GameTypeStrings[(int)value] : std::string_view();
+}
+
 std::string GetEnumString(GameType const &value);
-GameType GetGameTypeValue(const char *str);
+GameType GetGameTypeValue(std::string_view str);
+
+// Indexed by GameType, a bit per expansion BugType that the game adds
+inline constexpr uint32_t GameTypeExpansionBugs[NumGameTypes] = {
+    0,
+    1u << (int)BugType::Mosquito,
+    1u << (int)BugType::Ladybug,
+    1u << (int)BugType::Pillbug,
+    (1u << (int)BugType::Mosquito) | (1u << (int)BugType::Ladybug),
+    (1u << (int)BugType::Mosquito) | (1u << (int)BugType::Pillbug),
+    (1u << (int)BugType::Ladybug) | (1u << (int)BugType::Pillbug),
+    (1u << (int)BugType::Mosquito) | (1u << (int)BugType::Ladybug) | (1u << (int)BugType::Pillbug),
+};
 
-bool PieceNameIsEnabledForGameType(PieceName const &pieceName, GameType const &gameType);
+constexpr uint32_t GetEnabledPieceMask(GameType const &gameType)
+{
+    uint32_t mask = 0;
+    for (int pn = 0; pn < (int)PieceName::NumPieceNames; pn++)
+    {
+        auto bugType = PieceNameBugTypes[pn];
+        if (bugType < BugType::Mosquito || (GameTypeExpansionBugs[(int)gameType] & (1u << (int)bugType)) != 0)
+        {
+            mask |= 1u << pn;
+        }
+    }
+    return mask;
+}
+
+// Indexed by GameType, a bit per PieceName that's in the game
+inline constexpr uint32_t GameTypeEnabledPieceMasks[NumGameTypes] = {
+    GetEnabledPieceMask(GameType::Base),   GetEnabledPieceMask(GameType::BaseM),  GetEnabledPieceMask(GameType::BaseL),
+    GetEnabledPieceMask(GameType::BaseP),  GetEnabledPieceMask(GameType::BaseML), GetEnabledPieceMask(GameType::BaseMP),
+    GetEnabledPieceMask(GameType::BaseLP), GetEnabledPieceMask(GameType::BaseMLP),
+};
+
+constexpr bool PieceNameIsEnabledForGameType(PieceName const &pieceName, GameType const &gameType)
+{
+    return (unsigned)pieceName < (unsigned)PieceName::NumPieceNames && (unsigned)gameType < (unsigned)NumGameTypes &&
+           ((GameTypeEnabledPieceMasks[(int)gameType] >> (int)pieceName) & 1u) != 0;
+}
 
 } // namespace MzingaCpp
 
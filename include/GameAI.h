@@ -0,0 +1,55 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#ifndef GAMEAI_H
+#define GAMEAI_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Board.h"
+#include "Constants.h"
+#include "Move.h"
+
+namespace MzingaCpp
+{
+class GameAI
+{
+  public:
+    GameAI();
+
+    void Reset();
+
+    Move GetBestMove(std::shared_ptr<Board> board, int maxDepth, std::chrono::milliseconds maxTime);
+    Move GetBestMove(std::shared_ptr<Board> board, int maxDepth, std::chrono::milliseconds maxTime, int &bestScore);
+    bool TryGetMateMove(std::shared_ptr<Board> board, int maxMoves, std::chrono::milliseconds maxTime, Move &result);
+
+  private:
+    int Negamax(std::shared_ptr<Board> board, int depth, int ply, int alpha, int beta);
+    int Evaluate(std::shared_ptr<Board> board, int ply);
+
+    std::vector<Move> GetOrderedMoves(std::shared_ptr<Board> board, Move const &bestMove, int ply);
+    void UpdateMoveOrdering(Move const &move, Move const &previousMove, int depth, int ply);
+
+    int GetHistoryIndex(Move const &move);
+
+    bool AttackerCanMate(std::shared_ptr<Board> board, int movesLeft, Move &mateMove);
+    bool DefenderIsMated(std::shared_ptr<Board> board, int movesLeft);
+    std::vector<Move> GetMateCandidateMoves(std::shared_ptr<Board> board);
+
+    bool SearchAborted();
+
+    Move m_killerMoves[MaxSearchPly][NumKillerMoves];
+    std::vector<int> m_history;
+    std::vector<uint16_t> m_counterMoves; // History index of the reply, or NoCounterMove
+    bool m_historyUpdated = false;
+
+    std::chrono::steady_clock::time_point m_deadline;
+    long m_nodesSearched = 0;
+    bool m_searchAborted = false;
+};
+} // namespace MzingaCpp
+
+#endif
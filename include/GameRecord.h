@@ -0,0 +1,69 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#ifndef GAMERECORD_H
+#define GAMERECORD_H
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "Board.h"
+
+namespace MzingaCpp
+{
+// On-disk layout (little-endian): a GameRecordFileHeader followed by records,
+// each a GameRecordHeader followed by MoveCount packed moves
+struct GameRecordFileHeader
+{
+    char Magic[4];
+    uint32_t Version;
+};
+
+struct GameRecordHeader
+{
+    int8_t GameType;
+    int8_t BoardState;
+    uint16_t MoveCount;
+};
+
+static_assert(sizeof(GameRecordFileHeader) == 8, "GameRecordFileHeader must be 8 bytes");
+static_assert(sizeof(GameRecordHeader) == 4, "GameRecordHeader must be 4 bytes");
+
+// A move as it's written in UHP: the moving piece, the piece it's placed next
+// to (or on top of) and in which direction. Bits 0-4 are the moving piece, bits
+// 5-9 the target piece and bits 10-12 the direction from the target.
+typedef uint16_t PackedMove;
+
+class GameRecordWriter
+{
+  public:
+    GameRecordWriter(std::ostream &output);
+
+    bool TryWrite(std::string_view gameString);
+
+  private:
+    std::ostream &m_output;
+    bool m_fileHeaderWritten = false;
+
+    std::vector<PackedMove> m_moves;
+};
+
+class GameRecordReader
+{
+  public:
+    GameRecordReader(std::istream &input);
+
+    bool TryReadNext(std::shared_ptr<Board> &result);
+
+  private:
+    std::istream &m_input;
+    bool m_fileHeaderRead = false;
+
+    std::vector<PackedMove> m_moves;
+};
+} // namespace MzingaCpp
+
+#endif
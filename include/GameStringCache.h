@@ -0,0 +1,45 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#ifndef GAMESTRINGCACHE_H
+#define GAMESTRINGCACHE_H
+
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Board.h"
+#include "Move.h"
+
+namespace MzingaCpp
+{
+// Remembers the moves of recently loaded game strings, so loading one that
+// extends them, as when a client resyncs a game with newgame, only validates
+// the new moves. The rest are replayed without move generation.
+class GameStringCache
+{
+  public:
+    GameStringCache(size_t capacity);
+
+    // Same results as Board::TryParseGameString
+    bool TryParseGameString(std::string_view gameString, std::shared_ptr<Board> &result);
+
+  private:
+    struct Entry
+    {
+        // The game type and move tokens of the game string, joined by ';'
+        std::string Key;
+        std::vector<Move> Moves;
+        std::vector<std::string> MoveStrings;
+    };
+
+    size_t m_capacity;
+
+    // Most recently used first
+    std::list<Entry> m_entries;
+};
+} // namespace MzingaCpp
+
+#endif
@@ -5,6 +5,7 @@
 #define MOVE_H
 
 #include <string>
+#include <string_view>
 
 #include "Enums.h"
 #include "Position.h"
@@ -28,8 +29,10 @@ size_t hash(Move const &move);
 std::string BuildMoveString(bool &isPass, PieceName &startPiece, char &beforeSeperator, PieceName &endPiece,
                             char &afterSeperator);
 
-bool TryNormalizeMoveString(std::string const &moveString, std::string &result);
-bool TryNormalizeMoveString(std::string const &moveString, bool &isPass, PieceName &startPiece, char &beforeSeperator,
+Direction GetTargetDirection(char const &beforeSeperator, char const &afterSeperator);
+
+bool TryNormalizeMoveString(std::string_view moveString, std::string &result);
+bool TryNormalizeMoveString(std::string_view moveString, bool &isPass, PieceName &startPiece, char &beforeSeperator,
                             PieceName &endPiece, char &afterSeperator);
 } // namespace MzingaCpp
 
@@ -0,0 +1,72 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#ifndef OPENINGBOOK_H
+#define OPENINGBOOK_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+#include "Move.h"
+
+namespace MzingaCpp
+{
+// On-disk layout (little-endian): an OpeningBookHeader followed by EntryCount
+// OpeningBookEntry records sorted by Key, then by descending Weight
+struct OpeningBookHeader
+{
+    char Magic[4];
+    uint32_t Version;
+    uint64_t EntryCount;
+};
+
+struct OpeningBookEntry
+{
+    uint64_t Key;
+    uint32_t Weight;
+    int8_t PieceName;
+    int8_t Q;
+    int8_t R;
+    int8_t Stack;
+};
+
+static_assert(sizeof(OpeningBookHeader) == 16, "OpeningBookHeader must be 16 bytes");
+static_assert(sizeof(OpeningBookEntry) == 16, "OpeningBookEntry must be 16 bytes");
+
+class OpeningBook
+{
+  public:
+    OpeningBook() = default;
+    ~OpeningBook();
+
+    OpeningBook(OpeningBook const &) = delete;
+    OpeningBook &operator=(OpeningBook const &) = delete;
+
+    bool TryLoad(std::string const &path);
+    void Unload();
+
+    bool IsLoaded()
+    {
+        return m_entries != nullptr;
+    }
+
+    bool TryGetBookMove(std::shared_ptr<Board> board, Move &result);
+
+    static bool TryWrite(std::string const &path, std::vector<OpeningBookEntry> entries);
+
+  private:
+    void *m_mappedData = nullptr;
+    size_t m_mappedSize = 0;
+#ifdef _WIN32
+    void *m_fileMapping = nullptr;
+#endif
+
+    OpeningBookEntry const *m_entries = nullptr;
+    uint64_t m_entryCount = 0;
+};
+} // namespace MzingaCpp
+
+#endif
@@ -4,6 +4,7 @@
 #ifndef POSITION_H
 #define POSITION_H
 
+#include "Constants.h"
 #include "Enums.h"
 
 namespace MzingaCpp
@@ -35,6 +36,34 @@ static const int NeighborDeltas[(int)Direction::NumDirections + 1][3] = {
     {0, 0, 1},  // Above
 };
 
+// Cells flatten (Q, R) into a single index, so that neighbors are a constant offset away:
+// cell = (Q + BoardSize / 2) * BoardSize + (R + BoardSize / 2)
+static constexpr int NeighborCellOffsets[(int)Direction::NumDirections] = {
+    -1,            // Up
+    BoardSize - 1, // UpRight
+    BoardSize,     // DownRight
+    1,             // Down
+    1 - BoardSize, // DownLeft
+    -BoardSize,    // UpLeft
+};
+
+static constexpr int OriginCell = (BoardSize / 2) * BoardSize + (BoardSize / 2);
+
+constexpr int GetCell(Position const &position)
+{
+    return ((BoardSize / 2) + position.Q) * BoardSize + ((BoardSize / 2) + position.R);
+}
+
+constexpr int GetNeighborCell(int cell, Direction const &direction)
+{
+    return cell + NeighborCellOffsets[(int)direction];
+}
+
+constexpr Position GetCellPosition(int cell, int stack)
+{
+    return Position{cell / BoardSize - (BoardSize / 2), cell % BoardSize - (BoardSize / 2), stack};
+}
+
 bool operator==(Position const &lhs, Position const &rhs);
 bool operator!=(Position const &lhs, Position const &rhs);
 
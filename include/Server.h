@@ -0,0 +1,83 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Engine.h"
+
+namespace MzingaCpp
+{
+#ifdef __linux__
+constexpr const bool ServerSupported = true;
+#else
+constexpr const bool ServerSupported = false;
+#endif
+
+struct ServerSession;
+
+// Hosts an independent UHP session, with its own Engine, for every client of a
+// Unix domain socket. One thread multiplexes every client with epoll and runs
+// quick commands itself, while bestmove and perft go to a shared pool of
+// worker threads. Each session's commands still run one at a time, in order.
+class Server
+{
+  public:
+    Server(int numThreads);
+    ~Server();
+
+    Server(Server const &) = delete;
+    Server &operator=(Server const &) = delete;
+
+    bool TryLoadOpeningBook(std::string const &path);
+
+    // Serves clients until SIGINT or SIGTERM
+    bool Run(std::string const &socketPath);
+
+  private:
+    struct Job
+    {
+        std::shared_ptr<ServerSession> Session;
+        std::string Command;
+    };
+
+    void AcceptSessions();
+    void ReadSession(std::shared_ptr<ServerSession> const &session);
+    void RunCommands(std::shared_ptr<ServerSession> const &session);
+    void WriteSession(std::shared_ptr<ServerSession> const &session);
+    void UpdateSessionEvents(std::shared_ptr<ServerSession> const &session);
+    void CloseSession(std::shared_ptr<ServerSession> const &session);
+    void FinishJobs();
+
+    void RunJobs();
+    void StopWorkers();
+
+    int m_numThreads;
+    std::string m_bookPath;
+
+    int m_epollFd = -1;
+    int m_listenFd = -1;
+    int m_jobsDoneFd = -1;
+    int m_signalFd = -1;
+
+    std::unordered_map<int, std::shared_ptr<ServerSession>> m_sessions;
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_jobsMutex;
+    std::condition_variable m_jobsReady;
+    std::deque<Job> m_pendingJobs;
+    std::vector<std::shared_ptr<ServerSession>> m_finishedJobs;
+    bool m_stopping = false;
+};
+} // namespace MzingaCpp
+
+#endif
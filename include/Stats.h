@@ -0,0 +1,85 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace MzingaCpp
+{
+enum class StatCounter
+{
+    // Per-piece move generations, one per BugType
+    ValidMovesQueenBee = 0,
+    ValidMovesSpider,
+    ValidMovesBeetle,
+    ValidMovesGrasshopper,
+    ValidMovesSoldierAnt,
+    ValidMovesMosquito,
+    ValidMovesLadybug,
+    ValidMovesPillbug,
+    IsOneHive,
+    PlacementCacheHit,
+    PlacementCacheMiss,
+    SlideExpansion,
+    Allocation,
+    SetPosition,
+    NumStatCounters,
+};
+
+char const *GetStatCounterName(StatCounter const &counter);
+
+typedef uint64_t StatCounts[(int)StatCounter::NumStatCounters];
+
+#ifdef MZINGACPP_STATS
+
+constexpr const bool StatsEnabled = true;
+
+// Each thread counts into its own slot, which only it writes, so counting
+// needs no locks or atomic read-modify-writes. Slots start on their own cache
+// lines, so threads never write to the same line.
+struct alignas(64) StatSlot
+{
+    std::atomic<bool> InUse{false};
+    std::atomic<uint64_t> Counts[(int)StatCounter::NumStatCounters] = {};
+};
+
+StatSlot *GetThreadStatSlot();
+void IncrementSharedStat(StatCounter const &counter);
+
+inline void IncrementStat(StatCounter const &counter)
+{
+    thread_local StatSlot *slot = GetThreadStatSlot();
+    if (slot != nullptr)
+    {
+        auto &count = slot->Counts[(int)counter];
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    else
+    {
+        IncrementSharedStat(counter);
+    }
+}
+
+#define MZINGACPP_STAT(counter) ::MzingaCpp::IncrementStat(::MzingaCpp::StatCounter::counter)
+#define MZINGACPP_STAT_BUGTYPE(bugType)                                                                             \
+    ::MzingaCpp::IncrementStat(                                                                                     \
+        (::MzingaCpp::StatCounter)((int)::MzingaCpp::StatCounter::ValidMovesQueenBee + (int)(bugType)))
+
+#else
+
+constexpr const bool StatsEnabled = false;
+
+#define MZINGACPP_STAT(counter) ((void)0)
+#define MZINGACPP_STAT_BUGTYPE(bugType) ((void)0)
+
+#endif
+
+// Totals across all threads, including ones that have exited
+void GetStats(StatCounts &result);
+void ResetStats();
+} // namespace MzingaCpp
+
+#endif
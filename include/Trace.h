@@ -0,0 +1,87 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace MzingaCpp
+{
+constexpr const int MaxTraceNameLength = 23;
+
+struct TraceEvent
+{
+    char Name[MaxTraceNameLength + 1];
+    char const *ArgName;
+    int64_t Arg;
+    int64_t StartNs;
+    int64_t DurationNs;
+    int ThreadId;
+};
+
+#ifdef MZINGACPP_TRACING
+constexpr const bool TracingSupported = true;
+#else
+constexpr const bool TracingSupported = false;
+#endif
+
+extern std::atomic<bool> TracingEnabled;
+
+void StartTracing();
+void StopTracing();
+
+// Writes every thread's recorded events as Chrome trace JSON, which both
+// chrome://tracing and Perfetto can open
+bool TryDumpTrace(std::string const &path);
+
+int64_t GetTraceTimeNs();
+void RecordTraceEvent(std::string_view name, char const *argName, int64_t arg, int64_t startNs);
+
+// Records how long it's in scope for, if tracing was enabled when it was created
+class TraceScope
+{
+  public:
+    TraceScope(std::string_view name, char const *argName = nullptr, int64_t arg = 0)
+    {
+        if (TracingEnabled.load(std::memory_order_relaxed))
+        {
+            m_name = name;
+            m_argName = argName;
+            m_arg = arg;
+            m_startNs = GetTraceTimeNs();
+        }
+    }
+
+    ~TraceScope()
+    {
+        if (m_startNs >= 0)
+        {
+            RecordTraceEvent(m_name, m_argName, m_arg, m_startNs);
+        }
+    }
+
+    TraceScope(TraceScope const &) = delete;
+    TraceScope &operator=(TraceScope const &) = delete;
+
+  private:
+    std::string_view m_name;
+    char const *m_argName = nullptr;
+    int64_t m_arg = 0;
+    int64_t m_startNs = -1;
+};
+} // namespace MzingaCpp
+
+#ifdef MZINGACPP_TRACING
+#define MZINGACPP_TRACE_CONCAT(a, b) a##b
+#define MZINGACPP_TRACE_NAME(line) MZINGACPP_TRACE_CONCAT(traceScope, line)
+#define MZINGACPP_TRACE_SCOPE(...) ::MzingaCpp::TraceScope MZINGACPP_TRACE_NAME(__LINE__)(__VA_ARGS__)
+#else
+#define MZINGACPP_TRACE_SCOPE(...) ((void)0)
+#endif
+
+#endif
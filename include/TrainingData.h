@@ -0,0 +1,98 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#ifndef TRAININGDATA_H
+#define TRAININGDATA_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+#include "Enums.h"
+
+namespace MzingaCpp
+{
+// A searched position, written as-is (little-endian). Each piece's position is
+// split across the PieceQ, PieceR and PieceStack columns, and pieces in hand
+// have a stack of -1. Score is the search's score for the current color, and
+// Result is the BoardState the game ended in.
+struct TrainingRecord
+{
+    int8_t PieceQ[(int)PieceName::NumPieceNames];
+    int8_t PieceR[(int)PieceName::NumPieceNames];
+    int8_t PieceStack[(int)PieceName::NumPieceNames];
+    int8_t GameType;
+    int8_t CurrentColor;
+    int8_t Result;
+    int8_t SearchDepth;
+    uint16_t CurrentTurn;
+    uint16_t Reserved;
+    int32_t Score;
+};
+
+static_assert(sizeof(TrainingRecord) == 96, "TrainingRecord must be 96 bytes");
+
+// Collects records from any number of threads and writes them out on its own
+// thread, so that generating threads only wait on I/O if both buffers are full
+class TrainingDataWriter
+{
+  public:
+    TrainingDataWriter(std::ostream &output);
+    ~TrainingDataWriter();
+
+    void Write(std::vector<TrainingRecord> const &records);
+    bool Close();
+
+  private:
+    void WriteBuffers();
+
+    std::ostream &m_output;
+
+    std::mutex m_mutex;
+    std::condition_variable m_bufferChanged;
+    std::vector<TrainingRecord> m_frontBuffer;
+    std::vector<TrainingRecord> m_backBuffer;
+    bool m_backBufferFull = false;
+    bool m_closing = false;
+
+    std::thread m_writerThread;
+};
+
+// Searches every position of a set of games, either read from an existing
+// source or generated by self-play, and writes a TrainingRecord for each
+class TrainingDataExporter
+{
+  public:
+    TrainingDataExporter(int numThreads, int searchDepth);
+
+    // readNextGame is called under a lock, and returns false once there are no more games
+    long ExportGames(std::function<bool(std::shared_ptr<Board> &)> const &readNextGame, std::ostream &output);
+    long ExportSelfPlay(GameType gameType, int numGames, uint32_t seed, std::ostream &output);
+
+  private:
+    void ExportGames(std::function<bool(std::shared_ptr<Board> &)> const &readNextGame,
+                     TrainingDataWriter &writer);
+    void ExportSelfPlay(GameType gameType, int numGames, uint32_t seed, TrainingDataWriter &writer);
+
+    TrainingRecord GetRecord(std::shared_ptr<Board> board, int score);
+    void SetResult(std::vector<TrainingRecord> &records, BoardState const &result);
+
+    long RunThreads(std::ostream &output, std::function<void(TrainingDataWriter &)> const &exportThread);
+
+    int m_numThreads;
+    int m_searchDepth;
+
+    std::mutex m_inputMutex;
+    std::atomic<int> m_nextGame{0};
+    std::atomic<long> m_recordsExported{0};
+};
+} // namespace MzingaCpp
+
+#endif
@@ -0,0 +1,174 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "BatchRunner.h"
+#include "Constants.h"
+#include "OpeningBook.h"
+
+using namespace MzingaCpp;
+
+BatchRunner::BatchRunner(int numThreads, std::vector<std::string> const &commands)
+    : m_numThreads(numThreads > 0 ? numThreads : 1), m_commands(commands)
+{
+}
+
+bool BatchRunner::TryLoadOpeningBook(std::string const &path)
+{
+    // Every engine maps the book itself, so only check that it loads here
+    OpeningBook openingBook;
+    if (!openingBook.TryLoad(path))
+    {
+        return false;
+    }
+
+    m_bookPath = path;
+    return true;
+}
+
+bool BatchRunner::Run(std::istream &input, std::ostream &output)
+{
+    m_slots.assign(BatchWindowSize, BatchSlot());
+    m_numGamesRead = 0;
+    m_nextGame = 0;
+    m_numGamesWritten = 0;
+    m_inputDone = false;
+
+    // Every thread keeps its engine for the whole run, taking the next game as soon as it's done with one
+    std::vector<std::string> engineOutputs(m_numThreads);
+    std::vector<std::unique_ptr<Engine>> engines;
+    for (int i = 0; i < m_numThreads; i++)
+    {
+        engines.push_back(std::make_unique<Engine>(
+            [&engineOutputs, i](std::string_view engineOutput) { engineOutputs[i] += engineOutput; }));
+
+        if (!m_bookPath.empty())
+        {
+            engines.back()->TryLoadOpeningBook(m_bookPath);
+        }
+    }
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < m_numThreads; i++)
+    {
+        threads.emplace_back(&BatchRunner::RunGames, this, std::ref(*engines[i]), std::ref(engineOutputs[i]));
+    }
+
+    std::string result;
+
+    // Writes out the oldest game once it's done, waiting for it if asked to
+    auto writeNextGame = [&](bool wait) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            auto &slot = m_slots[m_numGamesWritten % BatchWindowSize];
+            if (wait)
+            {
+                m_gameDone.wait(lock, [&slot] { return slot.Done; });
+            }
+            else if (!slot.Done)
+            {
+                return false;
+            }
+
+            // Swap rather than copy, so buffers are reused instead of reallocated for every game
+            result.swap(slot.Result);
+            slot.Done = false;
+            m_numGamesWritten++;
+        }
+
+        output << result;
+        return true;
+    };
+
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+
+        if (line.empty())
+        {
+            continue;
+        }
+
+        // Write whatever's ready in order, and make room for this game if the window is full
+        while (writeNextGame(m_numGamesRead - m_numGamesWritten == BatchWindowSize))
+        {
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_slots[m_numGamesRead % BatchWindowSize].GameString.swap(line);
+            m_numGamesRead++;
+        }
+        m_gameReady.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inputDone = true;
+    }
+    m_gameReady.notify_all();
+
+    while (m_numGamesWritten < m_numGamesRead)
+    {
+        writeNextGame(true);
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    output.flush();
+    return (bool)output;
+}
+
+void BatchRunner::RunGames(Engine &engine, std::string &engineOutput)
+{
+    std::string gameString;
+    std::string newGameCommand;
+
+    while (true)
+    {
+        size_t game;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_gameReady.wait(lock, [this] { return m_nextGame < m_numGamesRead || m_inputDone; });
+            if (m_nextGame == m_numGamesRead)
+            {
+                return;
+            }
+
+            game = m_nextGame++;
+            gameString.swap(m_slots[game % BatchWindowSize].GameString);
+        }
+
+        engineOutput.clear();
+
+        newGameCommand.assign(CommandString_NewGame).append(" ").append(gameString);
+        engine.ReadLine(newGameCommand);
+
+        // Don't run the commands against the previous game if this one didn't load
+        if (engineOutput.compare(0, strlen(ErrString), ErrString) != 0)
+        {
+            for (auto const &command : m_commands)
+            {
+                engine.ReadLine(command);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto &slot = m_slots[game % BatchWindowSize];
+            slot.Result.swap(engineOutput);
+            slot.Done = true;
+        }
+        m_gameDone.notify_one();
+    }
+}
@@ -1,11 +1,15 @@
 // Copyright (c) Jon Thysell <http://jonthysell.com>
 // Licensed under the MIT License.
 
+#include <algorithm>
 #include <assert.h>
-#include <queue>
+#include <atomic>
+#include <bitset>
 #include <sstream>
 
 #include "Board.h"
+#include "Stats.h"
+#include "Trace.h"
 
 using namespace MzingaCpp;
 
@@ -13,42 +17,198 @@ using namespace MzingaCpp;
 
 #define CurrentTurnQueenInPlay PieceInPlay(m_currentColor == Color::White ? PieceName::wQ : PieceName::bQ)
 
-Board::Board(GameType gameType) : m_gameType(gameType)
+// Whether the piece at the given offset from a color's queen is in the game, known at compile time
+template <bool MosquitoEnabled, bool LadybugEnabled, bool PillbugEnabled>
+constexpr bool PieceOffsetIsEnabled(int offset)
 {
+    return offset == (int)PieceName::wM   ? MosquitoEnabled
+           : offset == (int)PieceName::wL ? LadybugEnabled
+           : offset == (int)PieceName::wP ? PillbugEnabled
+                                          : true;
+}
+
+constexpr int OppositeDirection(int direction)
+{
+    return (direction + (int)Direction::NumDirections / 2) % (int)Direction::NumDirections;
+}
+
+// Indexed by a bit per occupied neighbor of a cell, the directions a piece can slide out of it: the
+// slide position is open and exactly one of the two positions we slide between is occupied
+constexpr auto SlideEdgesByOccupancy = []() {
+    std::array<uint8_t, 1 << (int)Direction::NumDirections> slideEdges{};
+    for (int occupancy = 0; occupancy < (int)slideEdges.size(); occupancy++)
+    {
+        for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+        {
+            bool open = (occupancy & (1 << dir)) == 0;
+            bool rightOccupied = (occupancy & (1 << (int)RightOf((Direction)dir))) != 0;
+            bool leftOccupied = (occupancy & (1 << (int)LeftOf((Direction)dir))) != 0;
+            if (open && rightOccupied != leftOccupied)
+            {
+                slideEdges[occupancy] |= 1 << dir;
+            }
+        }
+    }
+    return slideEdges;
+}();
+
+// Whether a piece can climb or slide from a cell to its neighbor, given the heights of the two and of
+// the cells on either side, none counting the moving piece. Logic from
+// http://boardgamegeek.com/wiki/page/Hive_FAQ#toc9
+constexpr bool CanClimbBetween(int currentHeight, int destinationHeight, int leftHeight, int rightHeight)
+{
+    // At least one neighbor is present
+    if (currentHeight == 0 && destinationHeight == 0 && leftHeight == 0 && rightHeight == 0)
+    {
+        return false;
+    }
+
+    return !(destinationHeight < leftHeight && destinationHeight < rightHeight && currentHeight < leftHeight &&
+             currentHeight < rightHeight);
+}
+
+// Zero is never a valid board id, so scratch caches start out invalid
+static std::atomic<uint64_t> NextBoardId{1};
+
+// Working state for move generation and move strings. Each thread has its own, so the Board itself is
+// never written to and can be queried from several threads at once.
+struct MoveGenerationScratch
+{
+    // Destination cells of the piece being evaluated, deduplicated with a per-cell stamp. Every
+    // destination neighbors a piece in play, which bounds how many there can be.
+    uint32_t DestinationStamps[BoardCellCount];
+    uint32_t CurrentDestinationStamp;
+    int DestinationCells[(int)Direction::NumDirections * (int)PieceName::NumPieceNames];
+    int DestinationCount;
+
+    // First occupied neighbor direction of each stamped destination, shared by all moves there
+    int8_t ReferenceDirections[BoardCellCount];
+
+    // Distinct cells reached by the last slide search, not including its starting cell. Visited bits
+    // are cleared after each search, so the bitset never needs a full reset.
+    std::bitset<BoardCellCount> SlideVisited;
+    int SlideCells[(int)Direction::NumDirections * (int)PieceName::NumPieceNames];
+    int SlideCellCount;
+
+    // A bit per occupied neighbor of each hive perimeter cell, from which its slide edges follow, built
+    // once per position. While a piece slides, the cells around its vacated cell are patched, and
+    // restored afterwards.
+    uint8_t SlideOccupancy[BoardCellCount];
+    uint64_t SlideGraphBoardId;
+    uint64_t SlideGraphVersion;
+    int SlideFixupCells[(int)Direction::NumDirections + 1];
+    uint8_t SlideFixupOccupancy[(int)Direction::NumDirections + 1];
+    int SlideFixupCount;
+
+    int ValidPlacementCells[(int)Direction::NumDirections * (int)PieceName::NumPieceNames];
+    int ValidPlacementCount;
+    uint64_t ValidPlacementsBoardId;
+    uint64_t ValidPlacementsVersion;
+};
+
+// Constant initialized, so there's no per-access initialization check
+static thread_local MoveGenerationScratch Scratch;
+
+constexpr uint64_t BlackToMoveZobristKey = 0x9E3779B97F4A7C15ull;
+
+// Keys must be stable across processes and builds (opening books are keyed on
+// them), so they are derived from the piece and position with splitmix64
+// rather than from a randomly seeded table
+inline uint64_t GetPieceZobristKey(PieceName const &pieceName, int cell, int stack)
+{
+    auto position = GetCellPosition(cell, stack);
+    uint64_t z = ((uint64_t)pieceName << 32) | ((uint64_t)(position.Q & 0xFF) << 16) |
+                 ((uint64_t)(position.R & 0xFF) << 8) | (uint64_t)(position.Stack & 0xFF);
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+Board::Board(GameType gameType) : m_gameType(gameType), m_boardId(NextBoardId.fetch_add(1))
+{
+    // Pick the move generators with only this game type's bugs compiled in
+    switch (gameType)
+    {
+    case GameType::Base:
+        SetMoveGenerators<false, false, false>();
+        break;
+    case GameType::BaseM:
+        SetMoveGenerators<true, false, false>();
+        break;
+    case GameType::BaseL:
+        SetMoveGenerators<false, true, false>();
+        break;
+    case GameType::BaseP:
+        SetMoveGenerators<false, false, true>();
+        break;
+    case GameType::BaseML:
+        SetMoveGenerators<true, true, false>();
+        break;
+    case GameType::BaseMP:
+        SetMoveGenerators<true, false, true>();
+        break;
+    case GameType::BaseLP:
+        SetMoveGenerators<false, true, true>();
+        break;
+    default:
+        SetMoveGenerators<true, true, true>();
+        break;
+    }
+
     for (int pn = 0; pn < (int)PieceName::NumPieceNames; pn++)
     {
-        m_piecePositions[pn] = NullPosition;
+        m_pieceCells[pn] = OriginCell;
+        m_pieceStacks[pn] = -1;
     }
 
-    for (int q = 0; q < BoardSize; q++)
+    for (int cell = 0; cell < BoardCellCount; cell++)
     {
-        for (int r = 0; r < BoardSize; r++)
+        for (int stack = 0; stack < BoardStackSize; stack++)
         {
-            for (int stack = 0; stack < BoardStackSize; stack++)
-            {
-                m_pieceGrid[q][r][stack] = PieceName::INVALID;
-            }
+            m_pieceGrid[cell][stack] = PieceName::INVALID;
         }
+        m_cellHeights[cell] = 0;
     }
 }
 
-BoardState Board::GetBoardState()
+GameType Board::GetGameType() const
+{
+    return m_gameType;
+}
+
+BoardState Board::GetBoardState() const
 {
     return m_boardState;
 }
 
-int Board::GetCurrentTurn()
+Color Board::GetCurrentColor() const
+{
+    return m_currentColor;
+}
+
+int Board::GetCurrentTurn() const
 {
     return m_currentTurn;
 }
 
-std::string Board::GetGameString()
+Move Board::GetLastMove() const
+{
+    return m_moveHistory.size() > 0 ? m_moveHistory.back() : PassMove;
+}
+
+uint64_t Board::GetZobristKey() const
+{
+    return m_currentColor == Color::Black ? m_zobristKey ^ BlackToMoveZobristKey : m_zobristKey;
+}
+
+std::string Board::GetGameString() const
 {
     std::ostringstream str;
 
-    str << GetEnumString(m_gameType);
-    str << ";" << GetEnumString(m_boardState);
-    str << ";" << GetEnumString(m_currentColor) << "[" << CurrentPlayerTurn << "]";
+    str << GetEnumStringView(m_gameType);
+    str << ";" << GetEnumStringView(m_boardState);
+    str << ";" << GetEnumStringView(m_currentColor) << "[" << CurrentPlayerTurn << "]";
 
     for (auto const &iter : m_moveHistoryStr)
     {
@@ -58,17 +218,16 @@ std::string Board::GetGameString()
     return str.str();
 }
 
-std::shared_ptr<MoveSet> Board::GetValidMoves()
+std::shared_ptr<MoveSet> Board::GetValidMoves() const
 {
+    MZINGACPP_TRACE_SCOPE("GetValidMoves");
+
     auto validMoves = std::make_shared<MoveSet>();
+    MZINGACPP_STAT(Allocation);
 
     if (GameInProgress(m_boardState))
     {
-        for (int pn = (int)(m_currentColor == Color::White ? PieceName::wQ : PieceName::bQ);
-             pn < (int)(m_currentColor == Color::White ? PieceName::bQ : PieceName::NumPieceNames); pn++)
-        {
-            GetValidMoves((PieceName)pn, validMoves);
-        }
+        (this->*m_getValidMoves)(validMoves);
 
         if (validMoves->size() == 0)
         {
@@ -79,21 +238,258 @@ std::shared_ptr<MoveSet> Board::GetValidMoves()
     return validMoves;
 }
 
-bool Board::TryPlayMove(Move const &move, std::string moveString)
+long Board::CountValidMoves() const
+{
+    if (!GameInProgress(m_boardState))
+    {
+        return 0;
+    }
+
+    return (this->*m_countValidMoves)();
+}
+
+bool Board::IsValidMove(Move const &move) const
+{
+    if (!GameInProgress(m_boardState))
+    {
+        return false;
+    }
+
+    if (move == PassMove)
+    {
+        // Only valid when there's nothing else to do, which takes every piece to know
+        return GetValidMoves()->count(PassMove) > 0;
+    }
+
+    if ((unsigned)move.PieceName >= (unsigned)PieceName::NumPieceNames ||
+        !PieceNameIsEnabledForGameType(move.PieceName, m_gameType) || move.Source != GetPosition(move.PieceName) ||
+        (unsigned)(move.Destination.Q + BoardSize / 2) >= (unsigned)BoardSize ||
+        (unsigned)(move.Destination.R + BoardSize / 2) >= (unsigned)BoardSize ||
+        (unsigned)move.Destination.Stack >= (unsigned)BoardStackSize)
+    {
+        return false;
+    }
+
+    return (this->*m_isValidMove)(move);
+}
+
+template <bool MosquitoEnabled, bool LadybugEnabled, bool PillbugEnabled> void Board::SetMoveGenerators()
+{
+    m_getValidMoves = &Board::GetEnabledValidMoves<MosquitoEnabled, LadybugEnabled, PillbugEnabled>;
+    m_countValidMoves = &Board::CountEnabledValidMoves<MosquitoEnabled, LadybugEnabled, PillbugEnabled>;
+    m_isValidMove = &Board::IsEnabledValidMove<MosquitoEnabled, LadybugEnabled, PillbugEnabled>;
+}
+
+template <bool MosquitoEnabled, bool LadybugEnabled, bool PillbugEnabled>
+void Board::GetEnabledValidMoves(std::shared_ptr<MoveSet> moveSet) const
+{
+    int firstPiece = (int)(m_currentColor == Color::White ? PieceName::wQ : PieceName::bQ);
+    for (int offset = 0; offset < NumPieceNamesPerColor; offset++)
+    {
+        if (PieceOffsetIsEnabled<MosquitoEnabled, LadybugEnabled, PillbugEnabled>(offset))
+        {
+            GetEnabledValidMoves<MosquitoEnabled, LadybugEnabled, PillbugEnabled>((PieceName)(firstPiece + offset),
+                                                                                  moveSet);
+        }
+    }
+}
+
+template <bool MosquitoEnabled, bool LadybugEnabled, bool PillbugEnabled> long Board::CountEnabledValidMoves() const
+{
+    long count = 0;
+
+    int validPlacements = -1;
+
+    PieceName throwers[(int)PieceName::NumPieceNames];
+    int numThrowers = 0;
+
+    bool hasOwnMoves[(int)PieceName::NumPieceNames] = {};
+    bool canBeThrown[(int)PieceName::NumPieceNames] = {};
+
+    int firstPiece = (int)(m_currentColor == Color::White ? PieceName::wQ : PieceName::bQ);
+    for (int offset = 0; offset < NumPieceNamesPerColor; offset++)
+    {
+        if (!PieceOffsetIsEnabled<MosquitoEnabled, LadybugEnabled, PillbugEnabled>(offset))
+        {
+            continue;
+        }
+
+        int pn = firstPiece + offset;
+        auto pieceName = (PieceName)pn;
+
+        if (PieceInHand(pieceName))
+        {
+            // Every valid placement is a distinct move, so placements can be counted in bulk
+            if (PlacingPieceInOrder(pieceName))
+            {
+                if (m_currentTurn == 0)
+                {
+                    count += pieceName != PieceName::wQ ? 1 : 0;
+                }
+                else if (m_currentTurn == 1 || CurrentPlayerTurn != 4 || CurrentTurnQueenInPlay ||
+                         GetBugType(pieceName) == BugType::QueenBee)
+                {
+                    if (m_currentTurn == 1 && pieceName == PieceName::bQ)
+                    {
+                        continue;
+                    }
+
+                    if (validPlacements < 0)
+                    {
+                        validPlacements = CountValidPlacements();
+                    }
+                    count += validPlacements;
+                }
+            }
+        }
+        else if (CanMovePiece(pieceName))
+        {
+            hasOwnMoves[pn] = CanMoveWithoutBreakingHive(pieceName);
+
+            // Only pillbugs, and mosquitos next to them, can throw pieces
+            if constexpr (MosquitoEnabled || PillbugEnabled)
+            {
+                if (CanThrowPieces(pieceName))
+                {
+                    throwers[numThrowers++] = pieceName;
+
+                    for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+                    {
+                        auto neighbor =
+                            GetPieceAt(GetNeighborCell(m_pieceCells[pn], (Direction)dir), m_pieceStacks[pn]);
+                        if (neighbor != PieceName::INVALID)
+                        {
+                            canBeThrown[(int)neighbor] = true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // A piece moved by a pillbug may duplicate one of its own moves, so count the
+    // union of each piece's destinations
+    for (int pn = 0; pn < (int)PieceName::NumPieceNames; pn++)
+    {
+        auto pieceName = (PieceName)pn;
+
+        if (!hasOwnMoves[pn] && !canBeThrown[pn])
+        {
+            continue;
+        }
+
+        ResetDestinations();
+
+        if (hasOwnMoves[pn])
+        {
+            MZINGACPP_STAT_BUGTYPE(GetBugType(pieceName));
+            AddEnabledMovementDestinations<MosquitoEnabled, LadybugEnabled, PillbugEnabled>(pieceName,
+                                                                                            GetBugType(pieceName));
+        }
+
+        if (canBeThrown[pn])
+        {
+            for (int i = 0; i < numThrowers; i++)
+            {
+                for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+                {
+                    if (GetPieceAt(GetNeighborCell(m_pieceCells[(int)throwers[i]], (Direction)dir),
+                                   m_pieceStacks[(int)throwers[i]]) == pieceName)
+                    {
+                        AddValidThrowDestinations(throwers[i], (Direction)dir);
+                    }
+                }
+            }
+        }
+
+        count += Scratch.DestinationCount;
+    }
+
+    // Matches the pass inserted by GetValidMoves
+    return count > 0 ? count : 1;
+}
+
+// Applies the same rules as GetEnabledValidMoves and CountEnabledValidMoves, but only to the move's piece
+template <bool MosquitoEnabled, bool LadybugEnabled, bool PillbugEnabled>
+bool Board::IsEnabledValidMove(Move const &move) const
 {
-    auto validMoves = GetValidMoves();
+    auto pieceName = move.PieceName;
+    int pn = (int)pieceName;
+    int destinationCell = GetCell(move.Destination);
+
+    if (GetColor(pieceName) == m_currentColor && PieceInHand(pieceName))
+    {
+        if (!PlacingPieceInOrder(pieceName) || move.Destination.Stack != 0)
+        {
+            return false;
+        }
+
+        if (m_currentTurn == 0)
+        {
+            return pieceName != PieceName::wQ && move.Destination == OriginPosition;
+        }
+        else if (m_currentTurn == 1)
+        {
+            if (pieceName == PieceName::bQ)
+            {
+                return false;
+            }
+        }
+        else if (CurrentPlayerTurn == 4 && !CurrentTurnQueenInPlay && GetBugType(pieceName) != BugType::QueenBee)
+        {
+            return false;
+        }
 
-    auto it = validMoves->find(move);
-    if (it != validMoves->end())
+        CalculateValidPlacements();
+        return std::find(Scratch.ValidPlacementCells, Scratch.ValidPlacementCells + Scratch.ValidPlacementCount,
+                         destinationCell) != Scratch.ValidPlacementCells + Scratch.ValidPlacementCount;
+    }
+
+    if (PieceInHand(pieceName) || destinationCell == m_pieceCells[pn] ||
+        move.Destination.Stack != m_cellHeights[destinationCell])
+    {
+        return false;
+    }
+
+    ResetDestinations();
+
+    if (GetColor(pieceName) == m_currentColor && CanMovePiece(pieceName) && CanMoveWithoutBreakingHive(pieceName))
+    {
+        MZINGACPP_STAT_BUGTYPE(GetBugType(pieceName));
+        AddEnabledMovementDestinations<MosquitoEnabled, LadybugEnabled, PillbugEnabled>(pieceName,
+                                                                                        GetBugType(pieceName));
+    }
+
+    // Either color's pieces can be thrown, by any of the current color's throwers level with them
+    if constexpr (MosquitoEnabled || PillbugEnabled)
+    {
+        if (Scratch.DestinationStamps[destinationCell] != Scratch.CurrentDestinationStamp)
+        {
+            for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+            {
+                auto throwerName = GetPieceAt(GetNeighborCell(m_pieceCells[pn], (Direction)dir), m_pieceStacks[pn]);
+                if (throwerName != PieceName::INVALID && GetColor(throwerName) == m_currentColor &&
+                    CanMovePiece(throwerName) && CanThrowPieces(throwerName))
+                {
+                    AddValidThrowDestinations(throwerName, (Direction)OppositeDirection(dir));
+                }
+            }
+        }
+    }
+
+    return Scratch.DestinationStamps[destinationCell] == Scratch.CurrentDestinationStamp;
+}
+
+bool Board::TryPlayMove(Move const &move, std::string moveString)
+{
+    if (IsValidMove(move))
     {
         if (moveString.empty())
         {
             TryGetMoveString(move, moveString);
         }
 
-        m_moveHistoryStr.push_back(moveString);
-
-        TrustedPlay(move);
+        TrustedPlay(move, moveString);
 
         return true;
     }
@@ -128,77 +524,38 @@ bool Board::TryUndoLastMove()
     return false;
 }
 
-bool Board::TryGetMoveString(Move const &move, std::string &result)
+bool Board::TryGetMoveString(Move const &move, std::string &result) const
 {
-    if (move == PassMove)
-    {
-        result = PassMoveString;
-        return true;
-    }
-
-    std::string startPiece = GetEnumString(move.PieceName);
+    result.clear();
+    ResetDestinations();
+    return TryAppendMoveString(move, result);
+}
 
-    if (m_currentTurn == 0 && move.Destination == OriginPosition)
-    {
-        result = startPiece;
-        return true;
-    }
+void Board::GetMoveStrings(MoveSet const &moves, std::string &result) const
+{
+    result.clear();
+    result.reserve(moves.size() * (MaxMoveStringLength + 1));
 
-    std::string endPiece = "";
+    ResetDestinations();
 
-    if (move.Destination.Stack > 0)
+    bool first = true;
+    for (auto const &move : moves)
     {
-        PieceName pieceBelow = GetPieceAt(move.Destination.GetBelow());
-        endPiece = GetEnumString(pieceBelow);
-    }
-    else
-    {
-        SetPosition(move.PieceName, NullPosition);
-        for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+        if (!first)
         {
-            Position neighborPosition = move.Destination.GetNeighborAt((Direction)dir);
-            PieceName neighbor = GetPieceOnTopAt(neighborPosition);
-
-            if (neighbor != PieceName::INVALID && neighbor != move.PieceName)
-            {
-                endPiece = GetEnumString(neighbor);
-                switch (dir)
-                {
-                case 0: // Up
-                    endPiece = endPiece + "\\";
-                    break;
-                case 1: // UpRight
-                    endPiece = "/" + endPiece;
-                    break;
-                case 2: // DownRight
-                    endPiece = "-" + endPiece;
-                    break;
-                case 3: // Down
-                    endPiece = "\\" + endPiece;
-                    break;
-                case 4: // DownLeft
-                    endPiece = endPiece + "/";
-                    break;
-                case 5: // UpLeft
-                    endPiece = endPiece + "-";
-                    break;
-                }
-                break;
-            }
+            result += ';';
         }
-        SetPosition(move.PieceName, move.Source);
-    }
+        first = false;
 
-    if (!endPiece.empty())
-    {
-        result = (startPiece + " ") + endPiece;
-        return true;
+        auto length = result.length();
+        if (!TryAppendMoveString(move, result))
+        {
+            result.resize(length);
+        }
     }
-
-    return false;
 }
 
-bool Board::TryParseMove(std::string moveString, Move &result, std::string &resultString)
+bool Board::TryParseMove(std::string_view moveString, Move &result, std::string &resultString) const
 {
     bool isPass;
     PieceName startPiece;
@@ -216,58 +573,33 @@ bool Board::TryParseMove(std::string moveString, Move &result, std::string &resu
             return true;
         }
 
-        Position source = GetPosition(startPiece);
+        return TryGetMove(startPiece, endPiece, GetTargetDirection(beforeSeperator, afterSeperator), result);
+    }
 
-        Position destination = OriginPosition;
+    result = Move{};
+    return false;
+}
 
-        if (endPiece != PieceName::INVALID)
-        {
-            Position targetPosition = GetPosition(endPiece);
+bool Board::TryGetMove(PieceName const &pieceName, PieceName const &targetPieceName, Direction const &direction,
+                       Move &result) const
+{
+    Position destination = OriginPosition;
 
-            if (beforeSeperator != '\0')
-            {
-                // Moving piece on the left-hand side of the target piece
-                switch (beforeSeperator)
-                {
-                case '-':
-                    destination = targetPosition.GetNeighborAt(Direction::UpLeft).GetBottom();
-                    break;
-                case '/':
-                    destination = targetPosition.GetNeighborAt(Direction::DownLeft).GetBottom();
-                    break;
-                case '\\':
-                    destination = targetPosition.GetNeighborAt(Direction::Up).GetBottom();
-                    break;
-                }
-            }
-            else if (afterSeperator != '\0')
-            {
-                // Moving piece on the right-hand side of the target piece
-                switch (afterSeperator)
-                {
-                case '-':
-                    destination = targetPosition.GetNeighborAt(Direction::DownRight).GetBottom();
-                    break;
-                case '/':
-                    destination = targetPosition.GetNeighborAt(Direction::UpRight).GetBottom();
-                    break;
-                case '\\':
-                    destination = targetPosition.GetNeighborAt(Direction::Down).GetBottom();
-                    break;
-                }
-            }
-            else
-            {
-                destination = targetPosition.GetAbove();
-            }
+    if (targetPieceName != PieceName::INVALID)
+    {
+        if (PieceInHand(targetPieceName))
+        {
+            result = Move{};
+            return false;
         }
 
-        result = Move{startPiece, source, destination};
-        return true;
+        Position targetPosition = GetPosition(targetPieceName);
+        destination = direction == Direction::Above ? targetPosition.GetAbove()
+                                                    : targetPosition.GetNeighborAt(direction).GetBottom();
     }
 
-    result = Move{};
-    return false;
+    result = Move{pieceName, GetPosition(pieceName), destination};
+    return true;
 }
 
 long Board::CalculatePerft(int depth)
@@ -277,19 +609,20 @@ long Board::CalculatePerft(int depth)
         return 1;
     }
 
-    auto moves = GetValidMoves();
-
     if (depth == 1)
     {
-        return moves->size();
+        return CountValidMoves();
     }
 
+    MZINGACPP_TRACE_SCOPE("CalculatePerft", "depth", depth);
+
+    auto moves = GetValidMoves();
+
     long nodes = 0;
 
     for (auto const &move : *moves)
     {
-        TrustedPlay(move);
-        m_moveHistoryStr.push_back("");
+        TrustedPlay(move, "");
         auto value = CalculatePerft(depth - 1);
         TryUndoLastMove();
 
@@ -299,24 +632,67 @@ long Board::CalculatePerft(int depth)
     return nodes;
 }
 
-std::shared_ptr<Board> Board::Clone()
+std::shared_ptr<Board> Board::Clone() const
 {
     auto board = std::make_shared<Board>(m_gameType);
-    for (auto const &move : m_moveHistory)
+    MZINGACPP_STAT(Allocation);
+    for (size_t i = 0; i < m_moveHistory.size(); i++)
     {
-        board->TrustedPlay(move);
+        board->TrustedPlay(m_moveHistory[i], m_moveHistoryStr[i]);
+    }
+    return board;
+}
+
+bool Board::TryParseGameString(std::string_view gameString, std::shared_ptr<Board> &result)
+{
+    std::shared_ptr<Board> board = nullptr;
+
+    int itemIndex = 0;
+    while (!gameString.empty())
+    {
+        auto tokenLength = gameString.find(';');
+        auto token = gameString.substr(0, tokenLength);
+        gameString.remove_prefix(tokenLength != std::string_view::npos ? tokenLength + 1 : gameString.length());
+
+        if (!token.empty())
+        {
+            if (itemIndex == 0)
+            {
+                GameType gameType = GetGameTypeValue(token);
+                if (gameType == GameType::INVALID)
+                {
+                    return false;
+                }
+                board = std::make_shared<Board>(gameType);
+            }
+            else if (itemIndex > 2)
+            {
+                Move move;
+                std::string parsedMoveString;
+                if (!board->TryParseMove(token, move, parsedMoveString) || !board->TryPlayMove(move, parsedMoveString))
+                {
+                    return false;
+                }
+            }
+
+            itemIndex++;
+        }
     }
-    for (auto const &moveStr : m_moveHistoryStr)
+
+    if (board == nullptr)
     {
-        board->m_moveHistoryStr.push_back(moveStr);
+        return false;
     }
-    return board;
+
+    result = board;
+    return true;
 }
 
-void Board::GetValidMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet)
+template <bool MosquitoEnabled, bool LadybugEnabled, bool PillbugEnabled>
+void Board::GetEnabledValidMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const
 {
-    if (PieceNameIsEnabledForGameType(pieceName, m_gameType) && GameInProgress(m_boardState) &&
-        m_currentColor == GetColor(pieceName) && PlacingPieceInOrder(pieceName))
+    // The game is in progress and the piece is enabled and the current color's, so only check placement order
+    if (PlacingPieceInOrder(pieceName))
     {
         if (m_currentTurn == 0)
         {
@@ -332,9 +708,10 @@ void Board::GetValidMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> m
             if (pieceName != PieceName::bQ)
             {
                 CalculateValidPlacements();
-                for (auto const &iter : m_cachedValidPlacements)
+                for (int i = 0; i < Scratch.ValidPlacementCount; i++)
                 {
-                    moveSet->insert(Move{pieceName, GetPosition(pieceName), iter});
+                    moveSet->insert(
+                        Move{pieceName, GetPosition(pieceName), GetCellPosition(Scratch.ValidPlacementCells[i], 0)});
                 }
             }
         }
@@ -346,14 +723,17 @@ void Board::GetValidMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> m
                   (CurrentTurnQueenInPlay || (!CurrentTurnQueenInPlay && GetBugType(pieceName) == BugType::QueenBee)))))
             {
                 CalculateValidPlacements();
-                for (auto const &iter : m_cachedValidPlacements)
+                for (int i = 0; i < Scratch.ValidPlacementCount; i++)
                 {
-                    moveSet->insert(Move{pieceName, GetPosition(pieceName), iter});
+                    moveSet->insert(
+                        Move{pieceName, GetPosition(pieceName), GetCellPosition(Scratch.ValidPlacementCells[i], 0)});
                 }
             }
         }
         else if (pieceName != m_lastPieceMoved && CurrentTurnQueenInPlay && PieceIsOnTop(pieceName))
         {
+            MZINGACPP_STAT_BUGTYPE(GetBugType(pieceName));
+
             // Piece is in play and not covered
             if (CanMoveWithoutBreakingHive(pieceName))
             {
@@ -376,18 +756,27 @@ void Board::GetValidMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> m
                     GetValidSoldierAntMoves(pieceName, moveSet);
                     break;
                 case BugType::Mosquito:
-                    GetValidMosquitoMoves(pieceName, moveSet, false);
+                    if constexpr (MosquitoEnabled)
+                    {
+                        GetValidMosquitoMoves(pieceName, moveSet, false);
+                    }
                     break;
                 case BugType::Ladybug:
-                    GetValidLadybugMoves(pieceName, moveSet);
+                    if constexpr (LadybugEnabled)
+                    {
+                        GetValidLadybugMoves(pieceName, moveSet);
+                    }
                     break;
                 case BugType::Pillbug:
-                    GetValidPillbugBasicMoves(pieceName, moveSet);
-                    GetValidPillbugSpecialMoves(pieceName, moveSet);
+                    if constexpr (PillbugEnabled)
+                    {
+                        GetValidPillbugBasicMoves(pieceName, moveSet);
+                        GetValidPillbugSpecialMoves(pieceName, moveSet);
+                    }
                     break;
                 }
             }
-            else
+            else if constexpr (MosquitoEnabled || PillbugEnabled)
             {
                 // Check for special ability moves
                 switch (GetBugType(pieceName))
@@ -404,391 +793,892 @@ void Board::GetValidMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> m
     }
 }
 
-void Board::CalculateValidPlacements()
+void Board::CalculateValidPlacements() const
 {
-    if (!m_cachedValidPlacementsReady)
+    if (Scratch.ValidPlacementsBoardId == m_boardId && Scratch.ValidPlacementsVersion == m_positionVersion)
     {
+        MZINGACPP_STAT(PlacementCacheHit);
+    }
+    else
+    {
+        MZINGACPP_STAT(PlacementCacheMiss);
+
         if (m_currentTurn == 0)
         {
-            m_cachedValidPlacements.insert(OriginPosition);
+            Scratch.ValidPlacementCells[0] = OriginCell;
+            Scratch.ValidPlacementCount = 1;
         }
         else if (m_currentTurn == 1)
         {
-            for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+            for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+            {
+                Scratch.ValidPlacementCells[dir] = GetNeighborCell(OriginCell, (Direction)dir);
+            }
+            Scratch.ValidPlacementCount = (int)Direction::NumDirections;
+        }
+        else
+        {
+            ResetDestinations();
+            AddValidPlacementDestinations();
+            std::copy(Scratch.DestinationCells, Scratch.DestinationCells + Scratch.DestinationCount,
+                      Scratch.ValidPlacementCells);
+            Scratch.ValidPlacementCount = Scratch.DestinationCount;
+        }
+
+        Scratch.ValidPlacementsBoardId = m_boardId;
+        Scratch.ValidPlacementsVersion = m_positionVersion;
+    }
+}
+
+void Board::GetValidQueenBeeMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const
+{
+    GetValidSlides(pieceName, moveSet, 1);
+}
+
+void Board::GetValidSpiderMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const
+{
+    int startingCell = m_pieceCells[(int)pieceName];
+    BeginSlides(startingCell);
+    FindSpiderSlides(startingCell);
+    EndSlides();
+
+    auto startingPosition = GetCellPosition(startingCell, 0);
+    for (int i = 0; i < Scratch.SlideCellCount; i++)
+    {
+        moveSet->insert(Move{pieceName, startingPosition, GetCellPosition(Scratch.SlideCells[i], 0)});
+    }
+}
+
+void Board::GetValidBeetleMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const
+{
+    auto position = GetPosition(pieceName);
+    int cell = m_pieceCells[(int)pieceName];
+    int stack = m_pieceStacks[(int)pieceName];
+
+    // Look in all directions
+    for (int direction = 0; direction < (int)Direction::NumDirections; direction++)
+    {
+        int destinationStack;
+        if (TryGetBeetleMove(cell, stack, (Direction)direction, destinationStack))
+        {
+            moveSet->insert(Move{pieceName, position,
+                                 GetCellPosition(GetNeighborCell(cell, (Direction)direction), destinationStack)});
+        }
+    }
+}
+
+void Board::GetValidGrasshopperMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const
+{
+    auto startingPosition = GetPosition(pieceName);
+    int startingCell = m_pieceCells[(int)pieceName];
+
+    for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+    {
+        int landingCell;
+        if (TryGetGrasshopperMove(startingCell, (Direction)dir, landingCell))
+        {
+            moveSet->insert(Move{pieceName, startingPosition, GetCellPosition(landingCell, 0)});
+        }
+    }
+}
+
+void Board::GetValidSoldierAntMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const
+{
+    int startingCell = m_pieceCells[(int)pieceName];
+    BeginSlides(startingCell);
+    FloodFillSlides(startingCell);
+    EndSlides();
+
+    auto startingPosition = GetCellPosition(startingCell, 0);
+    for (int i = 0; i < Scratch.SlideCellCount; i++)
+    {
+        moveSet->insert(Move{pieceName, startingPosition, GetCellPosition(Scratch.SlideCells[i], 0)});
+    }
+}
+
+void Board::GetValidMosquitoMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet,
+                                  bool const &specialAbilityOnly) const
+{
+    if (m_pieceStacks[(int)pieceName] > 0 && !specialAbilityOnly)
+    {
+        // Mosquito on top acts like a beetle
+        GetValidBeetleMoves(pieceName, moveSet);
+        return;
+    }
+
+    int bugTypes = GetNeighborBugTypes(m_pieceCells[(int)pieceName]);
+
+    if ((bugTypes & (1 << (int)BugType::Pillbug)) != 0)
+    {
+        GetValidPillbugSpecialMoves(pieceName, moveSet);
+    }
+
+    if (specialAbilityOnly)
+    {
+        return;
+    }
+
+    // Every slide is on the way to an ant's destinations, so the ant covers the other sliders
+    if ((bugTypes & (1 << (int)BugType::SoldierAnt)) != 0)
+    {
+        GetValidSoldierAntMoves(pieceName, moveSet);
+    }
+    else
+    {
+        if ((bugTypes & (1 << (int)BugType::Spider)) != 0)
+        {
+            GetValidSpiderMoves(pieceName, moveSet);
+        }
+
+        // Queen and pillbug moves are the same single slide
+        if ((bugTypes & ((1 << (int)BugType::QueenBee) | (1 << (int)BugType::Pillbug))) != 0)
+        {
+            GetValidQueenBeeMoves(pieceName, moveSet);
+        }
+    }
+
+    if ((bugTypes & (1 << (int)BugType::Beetle)) != 0)
+    {
+        GetValidBeetleMoves(pieceName, moveSet);
+    }
+
+    if ((bugTypes & (1 << (int)BugType::Grasshopper)) != 0)
+    {
+        GetValidGrasshopperMoves(pieceName, moveSet);
+    }
+
+    if ((bugTypes & (1 << (int)BugType::Ladybug)) != 0)
+    {
+        GetValidLadybugMoves(pieceName, moveSet);
+    }
+}
+
+int Board::GetNeighborBugTypes(int cell) const
+{
+    int bugTypes = 0;
+    for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+    {
+        auto neighborPieceName = GetPieceOnTopAt(GetNeighborCell(cell, (Direction)dir));
+        if (neighborPieceName != PieceName::INVALID)
+        {
+            bugTypes |= 1 << (int)GetBugType(neighborPieceName);
+        }
+    }
+    return bugTypes;
+}
+
+void Board::GetValidLadybugMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const
+{
+    FindLadybugMoves(pieceName);
+
+    auto startingPosition = GetPosition(pieceName);
+    for (int i = 0; i < Scratch.SlideCellCount; i++)
+    {
+        moveSet->insert(Move{pieceName, startingPosition, GetCellPosition(Scratch.SlideCells[i], 0)});
+    }
+}
+
+void Board::GetValidPillbugBasicMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const
+{
+    GetValidSlides(pieceName, moveSet, 1);
+}
+
+void Board::GetValidPillbugSpecialMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet) const
+{
+    int cell = m_pieceCells[(int)pieceName];
+    int stack = m_pieceStacks[(int)pieceName];
+
+    for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+    {
+        int neighborCell = GetNeighborCell(cell, (Direction)dir);
+        auto neighborPieceName = GetPieceAt(neighborCell, stack);
+
+        if (neighborPieceName != PieceName::INVALID && neighborPieceName != m_lastPieceMoved &&
+            !HasPieceAt(neighborCell, stack + 1) && CanMoveWithoutBreakingHive(neighborPieceName))
+        {
+            // Piece can be moved on top
+            auto towardsPillbug = (Direction)((dir + 3) % (int)Direction::NumDirections);
+
+            int aboveStack;
+            if (TryGetBeetleMove(neighborCell, stack, towardsPillbug, aboveStack) && aboveStack == stack + 1)
+            {
+                // Once on top of the pillbug, the piece's old cell is one lower
+                for (int dir2 = 0; dir2 < (int)Direction::NumDirections; dir2++)
+                {
+                    int destinationCell = GetNeighborCell(cell, (Direction)dir2);
+                    int destinationStack;
+                    if (TryGetBeetleMove(cell, aboveStack, (Direction)dir2, destinationStack, neighborCell) &&
+                        destinationStack == 0 && destinationCell != neighborCell)
+                    {
+                        moveSet->insert(Move{neighborPieceName, GetCellPosition(neighborCell, stack),
+                                             GetCellPosition(destinationCell, 0)});
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Board::GetValidSlides(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet, int fixedRange) const
+{
+    int startingCell = m_pieceCells[(int)pieceName];
+    BeginSlides(startingCell);
+    GetValidSlides(pieceName, moveSet, startingCell, startingCell, startingCell, fixedRange);
+    EndSlides();
+}
+
+void Board::GetValidSlides(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet, int startingCell,
+                           int lastCell, int currentCell, int remainingSlides) const
+{
+    MZINGACPP_STAT(SlideExpansion);
+
+    if (remainingSlides == 0)
+    {
+        moveSet->insert(Move{pieceName, GetCellPosition(startingCell, 0), GetCellPosition(currentCell, 0)});
+    }
+    else
+    {
+        int slideEdges = SlideEdgesByOccupancy[Scratch.SlideOccupancy[currentCell]];
+        for (int slideDirection = 0; slideDirection < (int)Direction::NumDirections; slideDirection++)
+        {
+            int slideCell = GetNeighborCell(currentCell, (Direction)slideDirection);
+            if ((slideEdges & (1 << slideDirection)) != 0 && slideCell != lastCell && slideCell != startingCell)
+            {
+                // Can slide into slide position
+                GetValidSlides(pieceName, moveSet, startingCell, currentCell, slideCell, remainingSlides - 1);
+            }
+        }
+    }
+}
+
+void Board::FloodFillSlides(int startingCell) const
+{
+    // Breadth-first, with the queue doubling as the list of reachable cells
+    Scratch.SlideCellCount = 0;
+    Scratch.SlideVisited.set(startingCell);
+
+    for (int next = -1; next < Scratch.SlideCellCount; next++)
+    {
+        MZINGACPP_STAT(SlideExpansion);
+
+        int currentCell = next < 0 ? startingCell : Scratch.SlideCells[next];
+        int slideEdges = SlideEdgesByOccupancy[Scratch.SlideOccupancy[currentCell]];
+        for (int slideDirection = 0; slideDirection < (int)Direction::NumDirections; slideDirection++)
+        {
+            int slideCell = GetNeighborCell(currentCell, (Direction)slideDirection);
+            if ((slideEdges & (1 << slideDirection)) != 0 && !Scratch.SlideVisited.test(slideCell))
+            {
+                Scratch.SlideVisited.set(slideCell);
+                Scratch.SlideCells[Scratch.SlideCellCount++] = slideCell;
+            }
+        }
+    }
+
+    // Only clear the bits that were set, rather than the whole board
+    Scratch.SlideVisited.reset(startingCell);
+    for (int i = 0; i < Scratch.SlideCellCount; i++)
+    {
+        Scratch.SlideVisited.reset(Scratch.SlideCells[i]);
+    }
+}
+
+void Board::FindSpiderSlides(int startingCell) const
+{
+    // Walks of exactly three slides that never step back onto the cell they just left. In three steps
+    // that's the only way to revisit a cell, besides the starting cell, which is always excluded.
+    Scratch.SlideCellCount = 0;
+
+    int firstEdges = SlideEdgesByOccupancy[Scratch.SlideOccupancy[startingCell]];
+    for (int firstDirection = 0; firstDirection < (int)Direction::NumDirections; firstDirection++)
+    {
+        if ((firstEdges & (1 << firstDirection)) == 0)
+        {
+            continue;
+        }
+
+        MZINGACPP_STAT(SlideExpansion);
+
+        int firstCell = GetNeighborCell(startingCell, (Direction)firstDirection);
+        int secondEdges = SlideEdgesByOccupancy[Scratch.SlideOccupancy[firstCell]];
+        for (int secondDirection = 0; secondDirection < (int)Direction::NumDirections; secondDirection++)
+        {
+            int secondCell = GetNeighborCell(firstCell, (Direction)secondDirection);
+            if ((secondEdges & (1 << secondDirection)) == 0 || secondCell == startingCell)
+            {
+                continue;
+            }
+
+            MZINGACPP_STAT(SlideExpansion);
+
+            int thirdEdges = SlideEdgesByOccupancy[Scratch.SlideOccupancy[secondCell]];
+            for (int thirdDirection = 0; thirdDirection < (int)Direction::NumDirections; thirdDirection++)
+            {
+                int thirdCell = GetNeighborCell(secondCell, (Direction)thirdDirection);
+                if ((thirdEdges & (1 << thirdDirection)) != 0 && thirdCell != firstCell &&
+                    thirdCell != startingCell && !Scratch.SlideVisited.test(thirdCell))
+                {
+                    Scratch.SlideVisited.set(thirdCell);
+                    Scratch.SlideCells[Scratch.SlideCellCount++] = thirdCell;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < Scratch.SlideCellCount; i++)
+    {
+        Scratch.SlideVisited.reset(Scratch.SlideCells[i]);
+    }
+}
+
+void Board::BeginSlides(int vacatedCell) const
+{
+    assert(Scratch.SlideFixupCount == 0);
+
+    if (Scratch.SlideGraphBoardId != m_boardId || Scratch.SlideGraphVersion != m_positionVersion)
+    {
+        // Every cell a slide can reach borders the hive, so only the perimeter needs occupancy,
+        // which each piece in play adds to its open neighbors
+        for (int pn = 0; pn < (int)PieceName::NumPieceNames; pn++)
+        {
+            if (m_pieceStacks[pn] == 0)
             {
-                m_cachedValidPlacements.insert(OriginPosition.GetNeighborAt((Direction)dir));
+                for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+                {
+                    int cell = GetNeighborCell(m_pieceCells[pn], (Direction)dir);
+                    if (!HasPieceAt(cell))
+                    {
+                        Scratch.SlideOccupancy[cell] = 0;
+                    }
+                }
             }
         }
-        else
+
+        for (int pn = 0; pn < (int)PieceName::NumPieceNames; pn++)
         {
-            for (int pn = (int)(m_currentColor == Color::White ? PieceName::wQ : PieceName::bQ);
-                 pn < (int)(m_currentColor == Color::White ? PieceName::bQ : PieceName::NumPieceNames); pn++)
+            if (m_pieceStacks[pn] == 0)
             {
-                auto pieceName = (PieceName)pn;
-
-                if (PieceIsOnTop(pieceName))
+                for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
                 {
-                    auto bottomPosition = GetPosition(pieceName).GetBottom();
-
-                    for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+                    int cell = GetNeighborCell(m_pieceCells[pn], (Direction)dir);
+                    if (!HasPieceAt(cell))
                     {
-                        auto neighbor = bottomPosition.GetNeighborAt((Direction)dir);
-
-                        if (!HasPieceAt(neighbor))
-                        {
-                            // Neighboring position is a potential, verify its neighbors are empty or same color
-
-                            bool validPlacement = true;
-                            for (int dir2 = 0; dir2 < (int)Direction::NumDirections; dir2++)
-                            {
-                                auto surroundingPosition = neighbor.GetNeighborAt((Direction)dir2);
-                                auto surroundingPiece = GetPieceOnTopAt(surroundingPosition);
-                                if (surroundingPiece != PieceName::INVALID &&
-                                    GetColor(surroundingPiece) != m_currentColor)
-                                {
-                                    validPlacement = false;
-                                    break;
-                                }
-                            }
-
-                            if (validPlacement)
-                            {
-                                m_cachedValidPlacements.insert(neighbor);
-                            }
-                        }
+                        Scratch.SlideOccupancy[cell] |= 1 << OppositeDirection(dir);
                     }
                 }
             }
         }
-        m_cachedValidPlacementsReady = true;
+
+        Scratch.SlideGraphBoardId = m_boardId;
+        Scratch.SlideGraphVersion = m_positionVersion;
+    }
+
+    // Vacating the moving piece's cell only changes the occupancy of the cell itself and its open neighbors
+    uint8_t vacatedOccupancy = 0;
+    for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+    {
+        int cell = GetNeighborCell(vacatedCell, (Direction)dir);
+        if (HasPieceAt(cell))
+        {
+            vacatedOccupancy |= 1 << dir;
+        }
+        else
+        {
+            Scratch.SlideFixupCells[Scratch.SlideFixupCount] = cell;
+            Scratch.SlideFixupOccupancy[Scratch.SlideFixupCount++] = Scratch.SlideOccupancy[cell];
+            Scratch.SlideOccupancy[cell] &= ~(1 << OppositeDirection(dir));
+        }
     }
+
+    Scratch.SlideFixupCells[Scratch.SlideFixupCount] = vacatedCell;
+    Scratch.SlideFixupOccupancy[Scratch.SlideFixupCount++] = Scratch.SlideOccupancy[vacatedCell];
+    Scratch.SlideOccupancy[vacatedCell] = vacatedOccupancy;
 }
 
-void Board::GetValidQueenBeeMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet)
+void Board::EndSlides() const
 {
-    GetValidSlides(pieceName, moveSet, 1);
+    while (Scratch.SlideFixupCount > 0)
+    {
+        int fixup = --Scratch.SlideFixupCount;
+        Scratch.SlideOccupancy[Scratch.SlideFixupCells[fixup]] = Scratch.SlideFixupOccupancy[fixup];
+    }
 }
 
-void Board::GetValidSpiderMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet)
+bool Board::TryGetBeetleMove(int cell, int stack, Direction const &direction, int &destinationStack,
+                             int liftedCell) const
 {
-    GetValidSlides(pieceName, moveSet, 3);
+    // "Take-off" beetle, so the cell it leaves is as high as the pieces under it
+    int destinationHeight = GetHeight(GetNeighborCell(cell, direction), liftedCell);
+    if (CanClimbBetween(stack, destinationHeight, GetHeight(GetNeighborCell(cell, LeftOf(direction)), liftedCell),
+                        GetHeight(GetNeighborCell(cell, RightOf(direction)), liftedCell)))
+    {
+        destinationStack = destinationHeight;
+        return true;
+    }
+
+    return false;
 }
 
-void Board::GetValidBeetleMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet)
+void Board::FindLadybugMoves(PieceName const &pieceName) const
 {
-    auto position = GetPosition(pieceName);
-
-    // Look in all directions
-    for (int direction = 0; direction < (int)Direction::NumDirections; direction++)
+    // Two climbs onto the hive and one drop off it, walking top heights rather than moving the ladybug,
+    // so the only height that differs from the board's is the one of the cell the ladybug left
+    int startingCell = m_pieceCells[(int)pieceName];
+    int startingHeight = m_pieceStacks[(int)pieceName];
+    auto heightAt = [&](int cell) { return GetHeight(cell, startingCell); };
+    auto canClimb = [&](int cell, int dir, int currentHeight, int destinationHeight) {
+        return CanClimbBetween(currentHeight, destinationHeight,
+                               heightAt(GetNeighborCell(cell, LeftOf((Direction)dir))),
+                               heightAt(GetNeighborCell(cell, RightOf((Direction)dir))));
+    };
+
+    Scratch.SlideCellCount = 0;
+
+    for (int dir1 = 0; dir1 < (int)Direction::NumDirections; dir1++)
     {
-        auto newPosition = position.GetNeighborAt((Direction)direction);
+        int firstCell = GetNeighborCell(startingCell, (Direction)dir1);
+        int firstHeight = heightAt(firstCell);
+        if (firstHeight == 0 || !canClimb(startingCell, dir1, startingHeight, firstHeight))
+        {
+            continue;
+        }
+
+        for (int dir2 = 0; dir2 < (int)Direction::NumDirections; dir2++)
+        {
+            int secondCell = GetNeighborCell(firstCell, (Direction)dir2);
+            int secondHeight = heightAt(secondCell);
+            if (secondHeight == 0 || !canClimb(firstCell, dir2, firstHeight, secondHeight))
+            {
+                continue;
+            }
+
+            for (int dir3 = 0; dir3 < (int)Direction::NumDirections; dir3++)
+            {
+                int thirdCell = GetNeighborCell(secondCell, (Direction)dir3);
+                if (thirdCell != startingCell && heightAt(thirdCell) == 0 && !Scratch.SlideVisited.test(thirdCell) &&
+                    canClimb(secondCell, dir3, secondHeight, 0))
+                {
+                    Scratch.SlideVisited.set(thirdCell);
+                    Scratch.SlideCells[Scratch.SlideCellCount++] = thirdCell;
+                }
+            }
+        }
+    }
 
-        auto topNeighbor = GetPieceOnTopAt(newPosition);
+    for (int i = 0; i < Scratch.SlideCellCount; i++)
+    {
+        Scratch.SlideVisited.reset(Scratch.SlideCells[i]);
+    }
+}
 
-        // Get positions to left and right or direction we're heading
-        auto leftOfTarget = LeftOf((Direction)direction);
-        auto rightOfTarget = RightOf((Direction)direction);
-        auto leftNeighborPosition = position.GetNeighborAt(leftOfTarget);
-        auto rightNeighborPosition = position.GetNeighborAt(rightOfTarget);
+bool Board::TryGetGrasshopperMove(int cell, Direction const &direction, int &destinationCell) const
+{
+    int landingCell = GetNeighborCell(cell, direction);
 
-        auto topLeftNeighbor = GetPieceOnTopAt(leftNeighborPosition);
-        auto topRightNeighbor = GetPieceOnTopAt(rightNeighborPosition);
+    int distance = 0;
+    while (HasPieceAt(landingCell))
+    {
+        // Jump one more in the same direction
+        landingCell = GetNeighborCell(landingCell, direction);
+        distance++;
+    }
 
-        // At least one neighbor is present
-        uint32_t currentHeight = position.Stack + 1;
-        uint32_t destinationHeight = topNeighbor != PieceName::INVALID ? GetPosition(topNeighbor).Stack + 1 : 0;
+    if (distance > 0)
+    {
+        // Can only move if there's at least one piece in the way
+        destinationCell = landingCell;
+        return true;
+    }
 
-        uint32_t topLeftNeighborHeight =
-            topLeftNeighbor != PieceName::INVALID ? GetPosition(topLeftNeighbor).Stack + 1 : 0;
-        uint32_t topRightNeighborHeight =
-            topRightNeighbor != PieceName::INVALID ? GetPosition(topRightNeighbor).Stack + 1 : 0;
+    return false;
+}
 
-        // "Take-off" beetle
-        currentHeight--;
+bool Board::CanMovePiece(PieceName const &pieceName) const
+{
+    // Matches the conditions for moving a piece already in play in GetValidMoves
+    return m_currentTurn > 1 && pieceName != m_lastPieceMoved && CurrentTurnQueenInPlay && PieceIsOnTop(pieceName);
+}
 
-        if (!(currentHeight == 0 && destinationHeight == 0 && topLeftNeighborHeight == 0 &&
-              topRightNeighborHeight == 0))
+bool Board::CanThrowPieces(PieceName const &pieceName) const
+{
+    switch (GetBugType(pieceName))
+    {
+    case BugType::Pillbug:
+        return true;
+    case BugType::Mosquito: {
+        int cell = m_pieceCells[(int)pieceName];
+        if (m_pieceStacks[(int)pieceName] == 0)
         {
-            // Logic from http://boardgamegeek.com/wiki/page/Hive_FAQ#toc9
-            if (!(destinationHeight < topLeftNeighborHeight && destinationHeight < topRightNeighborHeight &&
-                  currentHeight < topLeftNeighborHeight && currentHeight < topRightNeighborHeight))
+            for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
             {
-                auto targetMove =
-                    Move{pieceName, position, Position{newPosition.Q, newPosition.R, (int)destinationHeight}};
-                moveSet->insert(targetMove);
+                auto neighborPieceName = GetPieceOnTopAt(GetNeighborCell(cell, (Direction)dir));
+                if (neighborPieceName != PieceName::INVALID && GetBugType(neighborPieceName) == BugType::Pillbug)
+                {
+                    return true;
+                }
             }
         }
+        return false;
+    }
+    default:
+        return false;
     }
 }
 
-void Board::GetValidGrasshopperMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet)
+int Board::CountValidPlacements() const
 {
-    auto startingPosition = GetPosition(pieceName);
-
-    for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+    if (m_currentTurn == 0)
+    {
+        return 1;
+    }
+    else if (m_currentTurn == 1)
     {
-        auto landingPosition = startingPosition.GetNeighborAt((Direction)dir);
+        return (int)Direction::NumDirections;
+    }
 
-        int distance = 0;
-        while (HasPieceAt(landingPosition))
-        {
-            // Jump one more in the same direction
-            landingPosition = landingPosition.GetNeighborAt((Direction)dir);
-            distance++;
-        }
+    MZINGACPP_STAT(PlacementCacheMiss);
 
-        if (distance > 0)
+    ResetDestinations();
+    AddValidPlacementDestinations();
+    return Scratch.DestinationCount;
+}
+
+void Board::ResetDestinations() const
+{
+    if (++Scratch.CurrentDestinationStamp == 0)
+    {
+        // Stamp wrapped around, so old stamps could look current
+        for (int cell = 0; cell < BoardCellCount; cell++)
         {
-            // Can only move if there's at least one piece in the way
-            moveSet->insert(Move{pieceName, startingPosition, landingPosition});
+            Scratch.DestinationStamps[cell] = 0;
         }
+        Scratch.CurrentDestinationStamp = 1;
     }
+    Scratch.DestinationCount = 0;
 }
 
-void Board::GetValidSoldierAntMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet)
+bool Board::AddDestination(int cell) const
 {
-    GetValidSlides(pieceName, moveSet, 0);
+    // For a given piece, a destination cell implies the stack height, so cells are enough to deduplicate
+    if (Scratch.DestinationStamps[cell] != Scratch.CurrentDestinationStamp)
+    {
+        Scratch.DestinationStamps[cell] = Scratch.CurrentDestinationStamp;
+        Scratch.DestinationCells[Scratch.DestinationCount++] = cell;
+        return true;
+    }
+    return false;
 }
 
-void Board::GetValidMosquitoMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet,
-                                  bool const &specialAbilityOnly)
+bool Board::TryAppendMoveString(Move const &move, std::string &result) const
 {
-    auto position = GetPosition(pieceName);
+    if (move == PassMove)
+    {
+        result += PassMoveString;
+        return true;
+    }
 
-    if (position.Stack > 0 && !specialAbilityOnly)
+    result += PieceNameStrings[(int)move.PieceName];
+
+    if (m_currentTurn == 0 && move.Destination == OriginPosition)
     {
-        // Mosquito on top acts like a beetle
-        GetValidBeetleMoves(pieceName, moveSet);
-        return;
+        return true;
     }
 
-    bool bugTypesEvaluated[(int)BugType::NumBugTypes] = {};
+    int destinationCell = GetCell(move.Destination);
 
-    for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+    if (move.Destination.Stack > 0)
+    {
+        result += ' ';
+        result += PieceNameStrings[(int)GetPieceAt(destinationCell, move.Destination.Stack - 1)];
+        return true;
+    }
+
+    if (AddDestination(destinationCell))
     {
-        auto neighborPosition = position.GetNeighborAt((Direction)dir);
-        auto neighborPieceName = GetPieceOnTopAt(neighborPosition);
+        int dir = 0;
+        while (dir < (int)Direction::NumDirections && !HasPieceAt(GetNeighborCell(destinationCell, (Direction)dir)))
+        {
+            dir++;
+        }
+        Scratch.ReferenceDirections[destinationCell] = (int8_t)dir;
+    }
 
-        auto neighborBugType = GetBugType(neighborPieceName);
+    int dir = Scratch.ReferenceDirections[destinationCell];
+    auto endPiece = PieceName::INVALID;
+    if (dir < (int)Direction::NumDirections)
+    {
+        int neighborCell = GetNeighborCell(destinationCell, (Direction)dir);
+        endPiece = GetPieceOnTopAt(neighborCell);
 
-        if (neighborPieceName != PieceName::INVALID && !bugTypesEvaluated[(int)(neighborBugType)])
+        if (endPiece == move.PieceName)
         {
-            auto newMoves = std::make_shared<MoveSet>();
-            if (specialAbilityOnly)
-            {
-                if (neighborBugType == BugType::Pillbug)
-                {
-                    GetValidPillbugSpecialMoves(pieceName, newMoves);
-                }
-            }
-            else
+            // The moving piece can't be its own reference, so use what's under it or the next neighbor
+            int stack = m_pieceStacks[(int)endPiece];
+            endPiece = stack > 0 ? GetPieceAt(neighborCell, stack - 1) : PieceName::INVALID;
+            while (endPiece == PieceName::INVALID && ++dir < (int)Direction::NumDirections)
             {
-                switch (neighborBugType)
-                {
-                case BugType::QueenBee:
-                    GetValidQueenBeeMoves(pieceName, newMoves);
-                    break;
-                case BugType::Spider:
-                    GetValidSpiderMoves(pieceName, newMoves);
-                    break;
-                case BugType::Beetle:
-                    GetValidBeetleMoves(pieceName, newMoves);
-                    break;
-                case BugType::Grasshopper:
-                    GetValidGrasshopperMoves(pieceName, newMoves);
-                    break;
-                case BugType::SoldierAnt:
-                    GetValidSoldierAntMoves(pieceName, newMoves);
-                    break;
-                case BugType::Ladybug:
-                    GetValidLadybugMoves(pieceName, newMoves);
-                    break;
-                case BugType::Pillbug:
-                    GetValidPillbugBasicMoves(pieceName, newMoves);
-                    GetValidPillbugSpecialMoves(pieceName, newMoves);
-                    break;
-                }
+                endPiece = GetPieceOnTopAt(GetNeighborCell(destinationCell, (Direction)dir));
             }
+        }
+    }
 
-            if (!newMoves->empty())
-            {
-                for (auto const &it : *newMoves)
-                {
-                    moveSet->insert(it);
-                }
-            }
+    if (endPiece == PieceName::INVALID)
+    {
+        return false;
+    }
 
-            bugTypesEvaluated[(int)(neighborBugType)] = true;
-        }
+    // Separators for Up, UpRight, DownRight, Down, DownLeft and UpLeft neighbors
+    static const char beforeSeperators[(int)Direction::NumDirections] = {'\0', '/', '-', '\\', '\0', '\0'};
+    static const char afterSeperators[(int)Direction::NumDirections] = {'\\', '\0', '\0', '\0', '/', '-'};
+
+    result += ' ';
+    if (beforeSeperators[dir] != '\0')
+    {
+        result += beforeSeperators[dir];
+    }
+    result += PieceNameStrings[(int)endPiece];
+    if (afterSeperators[dir] != '\0')
+    {
+        result += afterSeperators[dir];
     }
+
+    return true;
 }
 
-void Board::GetValidLadybugMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet)
+void Board::AddValidPlacementDestinations() const
 {
-    auto startingPosition = GetPosition(pieceName);
-
-    auto firstMoves = std::make_shared<MoveSet>();
-    GetValidBeetleMoves(pieceName, firstMoves);
-
-    for (auto const &firstMove : *firstMoves)
+    for (int pn = (int)(m_currentColor == Color::White ? PieceName::wQ : PieceName::bQ);
+         pn < (int)(m_currentColor == Color::White ? PieceName::bQ : PieceName::NumPieceNames); pn++)
     {
-        if (firstMove.Destination.Stack > 0)
-        {
-            SetPosition(pieceName, firstMove.Destination);
+        auto pieceName = (PieceName)pn;
 
-            auto secondMoves = std::make_shared<MoveSet>();
-            GetValidBeetleMoves(pieceName, secondMoves);
+        if (PieceIsOnTop(pieceName))
+        {
+            int bottomCell = m_pieceCells[pn];
 
-            for (auto const &secondMove : *secondMoves)
+            for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
             {
-                if (secondMove.Destination.Stack > 0)
-                {
-                    SetPosition(pieceName, secondMove.Destination);
+                int neighborCell = GetNeighborCell(bottomCell, (Direction)dir);
 
-                    auto thirdMoves = std::make_shared<MoveSet>();
-                    GetValidBeetleMoves(pieceName, thirdMoves);
-
-                    for (auto const &thirdMove : *thirdMoves)
+                if (!HasPieceAt(neighborCell))
+                {
+                    // Neighboring position is a potential, verify its neighbors are empty or same color
+                    bool validPlacement = true;
+                    for (int dir2 = 0; dir2 < (int)Direction::NumDirections; dir2++)
                     {
-                        if (thirdMove.Destination.Stack == 0 && thirdMove.Destination != startingPosition)
+                        auto surroundingPiece = GetPieceOnTopAt(GetNeighborCell(neighborCell, (Direction)dir2));
+                        if (surroundingPiece != PieceName::INVALID && GetColor(surroundingPiece) != m_currentColor)
                         {
-                            auto finalMove = Move{pieceName, startingPosition, thirdMove.Destination};
-                            moveSet->insert(finalMove);
+                            validPlacement = false;
+                            break;
                         }
                     }
 
-                    SetPosition(pieceName, firstMove.Destination);
+                    if (validPlacement)
+                    {
+                        AddDestination(neighborCell);
+                    }
                 }
             }
-
-            SetPosition(pieceName, startingPosition);
         }
     }
 }
 
-void Board::GetValidPillbugBasicMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet)
-{
-    GetValidSlides(pieceName, moveSet, 1);
-}
-
-void Board::GetValidPillbugSpecialMoves(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet)
+template <bool MosquitoEnabled, bool LadybugEnabled, bool PillbugEnabled>
+void Board::AddEnabledMovementDestinations(PieceName const &pieceName, BugType const &bugType) const
 {
-    auto position = GetPosition(pieceName);
-    auto positionAboveTargetPiece = position.GetAbove();
-
-    for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+    switch (bugType)
     {
-        auto neighborPosition = position.GetNeighborAt((Direction)dir);
-        auto neighborPieceName = GetPieceAt(neighborPosition);
+    case BugType::QueenBee:
+    case BugType::Pillbug:
+        AddValidSlideDestinations(pieceName, 1);
+        break;
+    case BugType::Spider:
+        AddValidSpiderDestinations(pieceName);
+        break;
+    case BugType::Beetle:
+        AddValidBeetleDestinations(pieceName);
+        break;
+    case BugType::Grasshopper:
+        AddValidGrasshopperDestinations(pieceName);
+        break;
+    case BugType::SoldierAnt:
+        AddValidSoldierAntDestinations(pieceName);
+        break;
+    case BugType::Mosquito: {
+        if constexpr (!MosquitoEnabled)
+        {
+            break;
+        }
 
-        if (neighborPieceName != PieceName::INVALID && neighborPieceName != m_lastPieceMoved &&
-            !HasPieceAt(neighborPosition, Direction::Above) && CanMoveWithoutBreakingHive(neighborPieceName))
+        if (m_pieceStacks[(int)pieceName] > 0)
         {
-            // Piece can be moved
-            auto firstMove = Move{neighborPieceName, neighborPosition, positionAboveTargetPiece};
-            auto firstMoves = std::make_shared<MoveSet>();
-            GetValidBeetleMoves(neighborPieceName, firstMoves);
-            if (firstMoves->find(firstMove) != firstMoves->end())
-            {
-                // Piece can be moved on top
-                SetPosition(neighborPieceName, positionAboveTargetPiece);
+            // Mosquito on top acts like a beetle
+            AddValidBeetleDestinations(pieceName);
+            break;
+        }
 
-                auto secondMoves = std::make_shared<MoveSet>();
-                GetValidBeetleMoves(neighborPieceName, secondMoves);
+        int bugTypes = GetNeighborBugTypes(m_pieceCells[(int)pieceName]);
 
-                for (auto const &secondMove : *secondMoves)
-                {
-                    if (secondMove.Destination.Stack == 0 && secondMove.Destination != neighborPosition)
-                    {
-                        auto finalMove = Move{neighborPieceName, neighborPosition, secondMove.Destination};
-                        moveSet->insert(finalMove);
-                    }
-                }
+        // Every slide is on the way to an ant's destinations, so the ant covers the other sliders, and
+        // queen and pillbug moves are the same single slide
+        if ((bugTypes & (1 << (int)BugType::SoldierAnt)) != 0)
+        {
+            bugTypes &= ~((1 << (int)BugType::QueenBee) | (1 << (int)BugType::Spider) | (1 << (int)BugType::Pillbug));
+        }
+        else if ((bugTypes & (1 << (int)BugType::Pillbug)) != 0)
+        {
+            bugTypes = (bugTypes & ~(1 << (int)BugType::Pillbug)) | (1 << (int)BugType::QueenBee);
+        }
 
-                SetPosition(neighborPieceName, neighborPosition);
+        for (int bt = 0; bt < (int)BugType::NumBugTypes; bt++)
+        {
+            if ((bugTypes & (1 << bt)) != 0 && bt != (int)BugType::Mosquito)
+            {
+                AddEnabledMovementDestinations<MosquitoEnabled, LadybugEnabled, PillbugEnabled>(pieceName,
+                                                                                                (BugType)bt);
             }
         }
+        break;
+    }
+    case BugType::Ladybug:
+        if constexpr (LadybugEnabled)
+        {
+            AddValidLadybugDestinations(pieceName);
+        }
+        break;
     }
 }
 
-void Board::GetValidSlides(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet, int fixedRange)
+void Board::AddValidSlideDestinations(PieceName const &pieceName, int fixedRange) const
 {
-    auto startingPosition = GetPosition(pieceName);
-    SetPosition(pieceName, NullPosition);
+    int startingCell = m_pieceCells[(int)pieceName];
+    BeginSlides(startingCell);
+    AddValidSlideDestinations(startingCell, startingCell, startingCell, fixedRange);
+    EndSlides();
+}
+
+void Board::AddValidSlideDestinations(int startingCell, int lastCell, int currentCell, int remainingSlides) const
+{
+    MZINGACPP_STAT(SlideExpansion);
 
-    if (fixedRange > 0)
+    if (remainingSlides == 0)
     {
-        GetValidSlides(pieceName, moveSet, startingPosition, startingPosition, startingPosition, fixedRange);
+        AddDestination(currentCell);
+        return;
     }
-    else
+
+    int slideEdges = SlideEdgesByOccupancy[Scratch.SlideOccupancy[currentCell]];
+    for (int slideDirection = 0; slideDirection < (int)Direction::NumDirections; slideDirection++)
     {
-        GetValidSlides(pieceName, moveSet, startingPosition, startingPosition, startingPosition);
+        int slideCell = GetNeighborCell(currentCell, (Direction)slideDirection);
+        if ((slideEdges & (1 << slideDirection)) != 0 && slideCell != lastCell && slideCell != startingCell)
+        {
+            AddValidSlideDestinations(startingCell, currentCell, slideCell, remainingSlides - 1);
+        }
     }
+}
 
-    SetPosition(pieceName, startingPosition);
+void Board::AddValidSpiderDestinations(PieceName const &pieceName) const
+{
+    int startingCell = m_pieceCells[(int)pieceName];
+    BeginSlides(startingCell);
+    FindSpiderSlides(startingCell);
+    EndSlides();
+
+    for (int i = 0; i < Scratch.SlideCellCount; i++)
+    {
+        AddDestination(Scratch.SlideCells[i]);
+    }
 }
 
-void Board::GetValidSlides(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet,
-                           Position const &startingPosition, Position const &lastPosition,
-                           Position const &currentPosition)
+void Board::AddValidSoldierAntDestinations(PieceName const &pieceName) const
 {
-    for (int slideDirection = 0; slideDirection < (int)Direction::NumDirections; slideDirection++)
+    int startingCell = m_pieceCells[(int)pieceName];
+    BeginSlides(startingCell);
+    FloodFillSlides(startingCell);
+    EndSlides();
+
+    for (int i = 0; i < Scratch.SlideCellCount; i++)
     {
-        auto const &slidePosition = currentPosition.GetNeighborAt((Direction)slideDirection);
-        if (slidePosition != lastPosition && slidePosition != startingPosition && !HasPieceAt(slidePosition))
-        {
-            // Slide position is open
-            if (HasPieceAt(currentPosition.GetNeighborAt(RightOf((Direction)slideDirection))) !=
-                HasPieceAt(currentPosition.GetNeighborAt(LeftOf((Direction)slideDirection))))
-            {
-                // Can slide into slide position
-                auto move = Move{pieceName, startingPosition, slidePosition};
+        AddDestination(Scratch.SlideCells[i]);
+    }
+}
 
-                if (moveSet->find(move) == moveSet->end())
-                {
-                    moveSet->insert(move);
-                    GetValidSlides(pieceName, moveSet, startingPosition, currentPosition, slidePosition);
-                }
-            }
+void Board::AddValidBeetleDestinations(PieceName const &pieceName) const
+{
+    int cell = m_pieceCells[(int)pieceName];
+    int stack = m_pieceStacks[(int)pieceName];
+
+    for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+    {
+        int destinationStack;
+        if (TryGetBeetleMove(cell, stack, (Direction)dir, destinationStack))
+        {
+            AddDestination(GetNeighborCell(cell, (Direction)dir));
         }
     }
 }
 
-void Board::GetValidSlides(PieceName const &pieceName, std::shared_ptr<MoveSet> moveSet,
-                           Position const &startingPosition, Position const &lastPosition,
-                           Position const &currentPosition, int remainingSlides)
+void Board::AddValidGrasshopperDestinations(PieceName const &pieceName) const
 {
-    if (remainingSlides == 0)
+    int cell = m_pieceCells[(int)pieceName];
+
+    for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
     {
-        auto move = Move{pieceName, startingPosition, currentPosition};
-        if (moveSet->find(move) == moveSet->end())
+        int destinationCell;
+        if (TryGetGrasshopperMove(cell, (Direction)dir, destinationCell))
         {
-            moveSet->insert(move);
+            AddDestination(destinationCell);
         }
     }
-    else
+}
+
+void Board::AddValidLadybugDestinations(PieceName const &pieceName) const
+{
+    FindLadybugMoves(pieceName);
+
+    for (int i = 0; i < Scratch.SlideCellCount; i++)
     {
-        for (int slideDirection = 0; slideDirection < (int)Direction::NumDirections; slideDirection++)
+        AddDestination(Scratch.SlideCells[i]);
+    }
+}
+
+void Board::AddValidThrowDestinations(PieceName const &throwerName, Direction const &direction) const
+{
+    int cell = m_pieceCells[(int)throwerName];
+    int stack = m_pieceStacks[(int)throwerName];
+
+    int neighborCell = GetNeighborCell(cell, direction);
+    auto neighborPieceName = GetPieceAt(neighborCell, stack);
+
+    if (neighborPieceName != PieceName::INVALID && neighborPieceName != m_lastPieceMoved &&
+        !HasPieceAt(neighborCell, stack + 1) && CanMoveWithoutBreakingHive(neighborPieceName))
+    {
+        // Piece must be able to climb on top of the thrower
+        auto towardsThrower = (Direction)(((int)direction + 3) % (int)Direction::NumDirections);
+
+        int aboveStack;
+        if (TryGetBeetleMove(neighborCell, stack, towardsThrower, aboveStack) && aboveStack == stack + 1)
         {
-            auto const &slidePosition = currentPosition.GetNeighborAt((Direction)slideDirection);
-            if (slidePosition != lastPosition && slidePosition != startingPosition && !HasPieceAt(slidePosition))
+            // Once on top of the thrower, the piece's old cell is one lower
+            for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
             {
-                // Slide position is open
-                if (HasPieceAt(currentPosition.GetNeighborAt(RightOf((Direction)slideDirection))) !=
-                    HasPieceAt(currentPosition.GetNeighborAt(LeftOf((Direction)slideDirection))))
+                int destinationCell = GetNeighborCell(cell, (Direction)dir);
+                int destinationStack;
+                if (TryGetBeetleMove(cell, aboveStack, (Direction)dir, destinationStack, neighborCell) &&
+                    destinationStack == 0 && destinationCell != neighborCell)
                 {
-                    // Can slide into slide position
-                    GetValidSlides(pieceName, moveSet, startingPosition, currentPosition, slidePosition,
-                                   remainingSlides - 1);
+                    AddDestination(destinationCell);
                 }
             }
         }
     }
 }
 
-void Board::TrustedPlay(Move const &move)
+void Board::TrustedPlay(Move const &move, std::string const &moveString)
 {
     m_moveHistory.push_back(move);
+    m_moveHistoryStr.push_back(moveString);
 
     if (move != PassMove)
     {
@@ -802,7 +1692,7 @@ void Board::TrustedPlay(Move const &move)
     ResetCaches();
 }
 
-bool Board::PlacingPieceInOrder(PieceName const &pieceName)
+bool Board::PlacingPieceInOrder(PieceName const &pieceName) const
 {
     if (PieceInHand(pieceName))
     {
@@ -838,107 +1728,97 @@ bool Board::PlacingPieceInOrder(PieceName const &pieceName)
     return true;
 }
 
-inline Position Board::GetPosition(PieceName const &pieceName)
+Position Board::GetPosition(PieceName const &pieceName) const
+{
+    return GetCellPosition(m_pieceCells[(int)pieceName], m_pieceStacks[(int)pieceName]);
+}
+
+void Board::SetPosition(PieceName const &pieceName, Position const &position)
 {
-    return m_piecePositions[(int)pieceName];
+    SetPosition(pieceName, GetCell(position), position.Stack);
 }
 
-inline void Board::SetPosition(PieceName const &pieceName, Position const &position)
+inline void Board::SetPosition(PieceName const &pieceName, int cell, int stack)
 {
-    auto oldPosition = GetPosition(pieceName);
-    m_piecePositions[(int)pieceName] = position;
+    MZINGACPP_STAT(SetPosition);
 
-    if (oldPosition.Stack >= 0)
+    int oldCell = m_pieceCells[(int)pieceName];
+    int oldStack = m_pieceStacks[(int)pieceName];
+
+    m_pieceCells[(int)pieceName] = cell;
+    m_pieceStacks[(int)pieceName] = stack;
+
+    // Pieces only ever leave or join the top of a stack
+    if (oldStack >= 0)
     {
-        m_pieceGrid[(BoardSize / 2) + oldPosition.Q][(BoardSize / 2) + oldPosition.R][oldPosition.Stack] =
-            PieceName::INVALID;
+        m_pieceGrid[oldCell][oldStack] = PieceName::INVALID;
+        m_cellHeights[oldCell] = (uint8_t)oldStack;
+        m_zobristKey ^= GetPieceZobristKey(pieceName, oldCell, oldStack);
     }
-    if (position.Stack >= 0)
+    if (stack >= 0)
     {
-        m_pieceGrid[(BoardSize / 2) + position.Q][(BoardSize / 2) + position.R][position.Stack] = pieceName;
+        m_pieceGrid[cell][stack] = pieceName;
+        m_cellHeights[cell] = (uint8_t)(stack + 1);
+        m_zobristKey ^= GetPieceZobristKey(pieceName, cell, stack);
     }
 }
 
-inline PieceName Board::GetPieceAt(Position const &position)
+inline PieceName Board::GetPieceAt(int cell, int stack) const
 {
-    assert(position.Stack >= 0);
-    return m_pieceGrid[(BoardSize / 2) + position.Q][(BoardSize / 2) + position.R][position.Stack];
+    assert(stack >= 0);
+    return m_pieceGrid[cell][stack];
 }
 
-PieceName Board::GetPieceAt(Position const &position, Direction const &direction)
+PieceName Board::GetPieceOnTopAt(int cell) const
 {
-    assert(position.Stack >= 0);
-    return m_pieceGrid[(BoardSize / 2) + position.Q + NeighborDeltas[(int)direction][0]]
-                      [(BoardSize / 2) + position.R + NeighborDeltas[(int)direction][1]]
-                      [position.Stack + NeighborDeltas[(int)direction][2]];
+    int height = m_cellHeights[cell];
+    return height > 0 ? m_pieceGrid[cell][height - 1] : PieceName::INVALID;
 }
 
-PieceName Board::GetPieceOnTopAt(Position const &position)
+inline int Board::GetHeight(int cell, int liftedCell) const
 {
-    auto topPieceName = PieceName::INVALID;
-    for (int stack = 0; stack < BoardStackSize; stack++)
-    {
-        auto pieceName = m_pieceGrid[(BoardSize / 2) + position.Q][(BoardSize / 2) + position.R][stack];
-        if (pieceName == PieceName::INVALID)
-        {
-            break;
-        }
-        topPieceName = pieceName;
-    }
-
-    return topPieceName;
+    return m_cellHeights[cell] - (cell == liftedCell ? 1 : 0);
 }
 
-bool Board::HasPieceAt(Position const &position)
+inline bool Board::HasPieceAt(int cell) const
 {
-    return GetPieceAt(position) != PieceName::INVALID;
+    return m_pieceGrid[cell][0] != PieceName::INVALID;
 }
 
-bool Board::HasPieceAt(Position const &position, Direction const &direction)
+inline bool Board::HasPieceAt(int cell, int stack) const
 {
-    return GetPieceAt(position, direction) != PieceName::INVALID;
+    return stack < BoardStackSize && GetPieceAt(cell, stack) != PieceName::INVALID;
 }
 
-inline bool Board::PieceInHand(PieceName const &pieceName)
+inline bool Board::PieceInHand(PieceName const &pieceName) const
 {
     assert(pieceName != PieceName::INVALID && pieceName != PieceName::NumPieceNames);
 
-    return (GetPosition(pieceName).Stack < 0);
+    return (m_pieceStacks[(int)pieceName] < 0);
 }
 
-inline bool Board::PieceInPlay(PieceName const &pieceName)
+bool Board::PieceInPlay(PieceName const &pieceName) const
 {
     assert(pieceName != PieceName::INVALID && pieceName != PieceName::NumPieceNames);
 
-    return (GetPosition(pieceName).Stack >= 0);
+    return (m_pieceStacks[(int)pieceName] >= 0);
 }
 
-bool Board::PieceIsOnTop(PieceName const &pieceName)
+bool Board::PieceIsOnTop(PieceName const &pieceName) const
 {
-    return PieceInPlay(pieceName) && !HasPieceAt(GetPosition(pieceName), Direction::Above);
+    return PieceInPlay(pieceName) && !HasPieceAt(m_pieceCells[(int)pieceName], m_pieceStacks[(int)pieceName] + 1);
 }
 
-bool Board::CanMoveWithoutBreakingHive(PieceName const &pieceName)
+bool Board::CanMoveWithoutBreakingHive(PieceName const &pieceName) const
 {
-    auto position = GetPosition(pieceName);
-    if (position.Stack == 0)
-    {
-        // Temporarily remove piece from board
-        SetPosition(pieceName, NullPosition);
-
-        // Determine if the hive is broken
-        bool isOneHive = IsOneHive();
-
-        // Return piece to the board
-        SetPosition(pieceName, position);
-
-        return isOneHive;
-    }
-    return true;
+    // Only a piece on the bottom can hold the hive together
+    return m_pieceStacks[(int)pieceName] != 0 || IsOneHive(pieceName);
 }
 
-bool Board::IsOneHive()
+bool Board::IsOneHive(PieceName const &ignoredPiece) const
 {
+    MZINGACPP_STAT(IsOneHive);
+
     bool partOfHive[(int)PieceName::NumPieceNames] = {};
     int piecesVisited = 0;
 
@@ -946,15 +1826,16 @@ bool Board::IsOneHive()
     auto startingPiece = PieceName::INVALID;
     for (int pn = 0; pn < (int)PieceName::NumPieceNames; pn++)
     {
-        if (PieceInHand((PieceName)pn))
+        if (PieceInHand((PieceName)pn) || pn == (int)ignoredPiece)
         {
+            // Pieces in hand, and the one being ignored, can't break the hive
             partOfHive[pn] = true;
             piecesVisited++;
         }
         else
         {
             partOfHive[pn] = false;
-            if (startingPiece == PieceName::INVALID && GetPosition((PieceName)pn).Stack == 0)
+            if (startingPiece == PieceName::INVALID && m_pieceStacks[pn] == 0)
             {
                 // Save off a starting piece on the bottom
                 startingPiece = (PieceName)pn;
@@ -967,35 +1848,41 @@ bool Board::IsOneHive()
     // There is at least one piece on the board
     if (startingPiece != PieceName::INVALID && piecesVisited < (int)PieceName::NumPieceNames)
     {
-        std::queue<PieceName> piecesToLookAt;
-        piecesToLookAt.push(startingPiece);
+        // Each piece is queued at most once
+        PieceName piecesToLookAt[(int)PieceName::NumPieceNames];
+        int nextPiece = 0;
+        int numPiecesToLookAt = 0;
+        piecesToLookAt[numPiecesToLookAt++] = startingPiece;
 
-        while (piecesToLookAt.size() > 0)
+        while (nextPiece < numPiecesToLookAt)
         {
-            auto currentPiece = piecesToLookAt.front();
-            piecesToLookAt.pop();
+            auto currentPiece = piecesToLookAt[nextPiece++];
 
-            auto currentPosition = GetPosition(currentPiece);
+            int currentCell = m_pieceCells[(int)currentPiece];
+            int currentStack = m_pieceStacks[(int)currentPiece];
 
             // Check all pieces at this stack level
             for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
             {
-                auto neighborPiece = GetPieceAt(currentPosition, (Direction)dir);
+                auto neighborPiece = GetPieceAt(GetNeighborCell(currentCell, (Direction)dir), currentStack);
                 if (neighborPiece != PieceName::INVALID && !partOfHive[(int)neighborPiece])
                 {
-                    piecesToLookAt.push(neighborPiece);
+                    piecesToLookAt[numPiecesToLookAt++] = neighborPiece;
                     partOfHive[(int)neighborPiece] = true;
                     piecesVisited++;
                 }
             }
 
             // Check for all pieces above this one
-            auto pieceAbove = GetPieceAt(currentPosition, Direction::Above);
-            while (PieceName::INVALID != pieceAbove)
+            for (int stack = currentStack + 1; stack < BoardStackSize; stack++)
             {
+                auto pieceAbove = GetPieceAt(currentCell, stack);
+                if (pieceAbove == PieceName::INVALID)
+                {
+                    break;
+                }
                 partOfHive[(int)pieceAbove] = true;
                 piecesVisited++;
-                pieceAbove = GetPieceAt(GetPosition(pieceAbove), Direction::Above);
             }
         }
     }
@@ -1003,16 +1890,16 @@ bool Board::IsOneHive()
     return piecesVisited == (int)PieceName::NumPieceNames;
 }
 
-int Board::CountNeighbors(PieceName const &pieceName)
+int Board::CountNeighbors(PieceName const &pieceName) const
 {
     int count = 0;
-    auto position = GetPosition(pieceName);
-    if (position.Stack >= 0)
+    int stack = m_pieceStacks[(int)pieceName];
+    if (stack >= 0)
     {
+        int cell = m_pieceCells[(int)pieceName];
         for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
         {
-            auto neighbor = GetPieceAt(position, (Direction)dir);
-            if (neighbor != PieceName::INVALID)
+            if (GetPieceAt(GetNeighborCell(cell, (Direction)dir), stack) != PieceName::INVALID)
             {
                 count++;
             }
@@ -1048,6 +1935,6 @@ void Board::ResetState()
 
 void Board::ResetCaches()
 {
-    m_cachedValidPlacementsReady = false;
-    m_cachedValidPlacements.clear();
+    // Cached results in each thread's scratch space are for an older version, so they'll be recalculated
+    m_positionVersion++;
 }
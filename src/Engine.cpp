@@ -1,17 +1,22 @@
 // Copyright (c) Jon Thysell <http://jonthysell.com>
 // Licensed under the MIT License.
 
+#include <charconv>
 #include <chrono>
 #include <cmath>
 #include <sstream>
 
 #include "Constants.h"
 #include "Engine.h"
+#include "Trace.h"
 
 using namespace MzingaCpp;
 
-Engine::Engine(std::function<void(std::string)> writeLine) : m_writeLine{writeLine}
+Engine::Engine(std::function<void(std::string_view)> writeOutput) : m_writeOutput{writeOutput}
 {
+    // The search's move ordering tables are large, so they're only made once something searches
+    m_openingBook = std::make_shared<OpeningBook>();
+    m_gameStringCache = std::make_shared<GameStringCache>(GameStringCacheSize);
 }
 
 void Engine::Start()
@@ -19,93 +24,153 @@ void Engine::Start()
     Info();
 }
 
-void Engine::ReadLine(std::string line)
+// Splits off the next space-delimited token, leaving str at the remainder
+inline std::string_view NextToken(std::string_view &str)
 {
-    std::string command;
-    std::string args;
+    auto start = str.find_first_not_of(' ');
+    if (start == std::string_view::npos)
+    {
+        str = std::string_view();
+        return str;
+    }
+
+    str.remove_prefix(start);
+
+    auto length = str.find(' ');
+    auto token = str.substr(0, length);
+    str.remove_prefix(length != std::string_view::npos ? length : str.length());
+
+    return token;
+}
+
+inline bool TryParseInt(std::string_view str, int &result)
+{
+    auto end = str.data() + str.length();
+    auto parseResult = std::from_chars(str.data(), end, result);
+    return parseResult.ec == std::errc() && parseResult.ptr == end;
+}
+
+void Engine::ReadLine(std::string_view line)
+{
+    auto command = NextToken(line);
 
-    std::istringstream ss(line);
-    std::ostringstream argStream;
+    MZINGACPP_TRACE_SCOPE(command);
 
-    std::string token;
+    // Arguments are the rest of the line, minus surrounding spaces
+    auto argsStart = line.find_first_not_of(' ');
+    auto args = argsStart != std::string_view::npos ? line.substr(argsStart, line.find_last_not_of(' ') - argsStart + 1)
+                                                    : std::string_view();
 
-    int itemIndex = 0;
-    while (std::getline(ss, token, ' '))
+    // Dispatch on the first character so that only commands sharing it are compared
+    switch (!command.empty() ? command[0] : '\0')
     {
-        if (!token.empty())
+    case 'i':
+        if (command == CommandString_Info)
         {
-            if (itemIndex == 0)
-            {
-                command = token;
-            }
-            else if (itemIndex == 1)
-            {
-                argStream << token;
-            }
-            else
-            {
-                argStream << " " << token;
-            }
-            itemIndex++;
+            Info();
+            return;
+        }
+        break;
+    case 'n':
+        if (command == CommandString_NewGame)
+        {
+            NewGame(args);
+            return;
+        }
+        break;
+    case 'v':
+        if (command == CommandString_ValidMoves)
+        {
+            ValidMoves();
+            return;
+        }
+        break;
+    case 'b':
+        if (command == CommandString_BestMove)
+        {
+            BestMove(args);
+            return;
+        }
+        break;
+    case 'p':
+        if (command == CommandString_Play)
+        {
+            Play(args);
+            return;
+        }
+        else if (command == CommandString_Pass)
+        {
+            Pass();
+            return;
+        }
+        else if (command == CommandString_Perft)
+        {
+            Perft(args);
+            return;
+        }
+        break;
+    case 's':
+        if (command == CommandString_Stats)
+        {
+            Stats(args);
+            return;
+        }
+        break;
+    case 't':
+        if (command == CommandString_Trace)
+        {
+            Trace(args);
+            return;
         }
+        break;
+    case 'u':
+        if (command == CommandString_Undo)
+        {
+            Undo(args);
+            return;
+        }
+        break;
+    case 'o':
+        if (command == CommandString_Options)
+        {
+            Options();
+            return;
+        }
+        break;
+    case 'e':
+        if (command == CommandString_Exit)
+        {
+            Exit();
+            return;
+        }
+        break;
     }
 
-    args = argStream.str();
+    WriteError(ErrorMessage_InvalidCommand);
+}
 
-    if (command == CommandString_Info)
-    {
-        Info();
-    }
-    else if (command == CommandString_NewGame)
-    {
-        NewGame(args);
-    }
-    else if (command == CommandString_ValidMoves)
-    {
-        ValidMoves();
-    }
-    else if (command == CommandString_BestMove)
-    {
-        BestMove();
-    }
-    else if (command == CommandString_Play)
-    {
-        Play(args);
-    }
-    else if (command == CommandString_Pass)
-    {
-        Pass();
-    }
-    else if (command == CommandString_Undo)
-    {
-        Undo(args);
-    }
-    else if (command == CommandString_Options)
-    {
-        Options();
-    }
-    else if (command == CommandString_Perft)
-    {
-        Perft(args);
-    }
-    else if (command == CommandString_Exit)
-    {
-        Exit();
-    }
-    else
-    {
-        WriteError(ErrorMessage_InvalidCommand);
-    }
+bool Engine::TryLoadOpeningBook(std::string const &path)
+{
+    return m_openingBook->TryLoad(path);
 }
 
-void Engine::WriteLine(std::string line)
+void Engine::WriteLine(std::string_view line)
 {
-    m_writeLine(line);
+    m_outputBuffer += line;
+    m_outputBuffer += '\n';
+
+    // Every command's output ends with ok, so that's the only time the output needs to be flushed
+    if (line == OkString)
+    {
+        FlushOutput();
+    }
 }
 
-void Engine::WriteError(std::string message)
+void Engine::WriteError(std::string_view message)
 {
-    WriteLine(ErrString + (" " + message));
+    m_outputBuffer += ErrString;
+    m_outputBuffer += ' ';
+    WriteLine(message);
     WriteLine(OkString);
 }
 
@@ -114,6 +179,25 @@ void Engine::WriteError()
     WriteError(ErrorMessage_Unknown);
 }
 
+void Engine::FlushOutput()
+{
+    if (!m_outputBuffer.empty())
+    {
+        m_writeOutput(m_outputBuffer);
+        m_outputBuffer.clear();
+    }
+}
+
+void Engine::WriteStats(StatCounts const &stats)
+{
+    for (int i = 0; i < (int)StatCounter::NumStatCounters; i++)
+    {
+        m_outputBuffer += GetStatCounterName((StatCounter)i);
+        m_outputBuffer += " = ";
+        WriteLine(std::to_string(stats[i]));
+    }
+}
+
 void Engine::Info()
 {
     WriteLine(IdString);
@@ -121,51 +205,22 @@ void Engine::Info()
     WriteLine(OkString);
 }
 
-void Engine::NewGame(std::string args)
+void Engine::NewGame(std::string_view args)
 {
-    GameType gameType = GameType::Base;
-
-    if (!args.empty())
+    if (args.empty())
     {
-        std::istringstream ss(args);
-
-        std::string token;
-
-        int itemIndex = 0;
-        while (std::getline(ss, token, ';'))
-        {
-            if (!token.empty())
-            {
-                if (itemIndex == 0)
-                {
-                    gameType = GetGameTypeValue(token.c_str());
-                    if (gameType == GameType::INVALID)
-                    {
-                        WriteError(ErrorMessage_Unknown);
-                        return;
-                    }
-                    m_board = std::make_shared<Board>(gameType);
-                }
-                if (itemIndex > 2)
-                {
-                    Move move;
-                    std::string parsedMoveString;
-                    if (!m_board->TryParseMove(token, move, parsedMoveString) ||
-                        !m_board->TryPlayMove(move, parsedMoveString))
-                    {
-                        WriteError(ErrorMessage_Unknown);
-                        return;
-                    }
-                }
-
-                itemIndex++;
-            }
-        }
+        m_board = std::make_shared<Board>(GameType::Base);
+    }
+    else if (!m_gameStringCache->TryParseGameString(args, m_board))
+    {
+        WriteError(ErrorMessage_Unknown);
+        return;
     }
 
-    if (m_board == nullptr)
+    // Move ordering learned in another game doesn't apply to this one
+    if (m_gameAI)
     {
-        m_board = std::make_shared<Board>(gameType);
+        m_gameAI->Reset();
     }
 
     WriteLine(m_board->GetGameString());
@@ -188,27 +243,14 @@ void Engine::ValidMoves()
 
     auto validMoves = m_board->GetValidMoves();
 
-    std::ostringstream str;
-    bool first = true;
-    for (auto const &iter : *validMoves)
-    {
-        std::string moveString;
-        if (m_board->TryGetMoveString(iter, moveString))
-        {
-            if (!first)
-            {
-                str << ";";
-            }
-            str << moveString;
-        }
-        first = false;
-    }
+    std::string moveStrings;
+    m_board->GetMoveStrings(*validMoves, moveStrings);
 
-    WriteLine(str.str());
+    WriteLine(moveStrings);
     WriteLine(OkString);
 }
 
-void Engine::BestMove()
+void Engine::BestMove(std::string_view args)
 {
     if (!m_board)
     {
@@ -222,9 +264,70 @@ void Engine::BestMove()
         return;
     }
 
-    auto validMoves = m_board->GetValidMoves();
+    int maxDepth = DefaultMaxSearchDepth;
+    int maxMateMoves = 0;
+    std::chrono::milliseconds maxTime{0};
+
+    auto limitType = NextToken(args);
+    if (!limitType.empty())
+    {
+        if (limitType == BestMoveArg_Depth)
+        {
+            if (!TryParseInt(NextToken(args), maxDepth) || maxDepth < 1)
+            {
+                WriteError(ErrorMessage_Unknown);
+                return;
+            }
+        }
+        else if (limitType == BestMoveArg_Time)
+        {
+            auto time = NextToken(args);
+            int hours, minutes, seconds;
+            auto firstSep = time.find(':');
+            auto secondSep = firstSep != std::string_view::npos ? time.find(':', firstSep + 1) : std::string_view::npos;
+            if (secondSep == std::string_view::npos || !TryParseInt(time.substr(0, firstSep), hours) ||
+                !TryParseInt(time.substr(firstSep + 1, secondSep - firstSep - 1), minutes) ||
+                !TryParseInt(time.substr(secondSep + 1), seconds))
+            {
+                WriteError(ErrorMessage_Unknown);
+                return;
+            }
+            maxDepth = MaxSearchPly;
+            maxTime = std::chrono::hours(hours) + std::chrono::minutes(minutes) + std::chrono::seconds(seconds);
+        }
+        else if (limitType == BestMoveArg_Mate)
+        {
+            if (!TryParseInt(NextToken(args), maxMateMoves) || maxMateMoves < 1)
+            {
+                WriteError(ErrorMessage_Unknown);
+                return;
+            }
+        }
+        else
+        {
+            WriteError(ErrorMessage_Unknown);
+            return;
+        }
+    }
 
-    Move bestMove = *(validMoves->begin());
+    if (!m_gameAI)
+    {
+        m_gameAI = std::make_shared<GameAI>();
+    }
+
+    Move bestMove;
+    if (maxMateMoves > 0)
+    {
+        // Fall back to a regular search if there's no forced surround, or none was found in time
+        if (!m_gameAI->TryGetMateMove(m_board, maxMateMoves, std::chrono::seconds(MaxMateSearchSeconds), bestMove))
+        {
+            bestMove = m_gameAI->GetBestMove(m_board, maxDepth, maxTime);
+        }
+    }
+    else if (!m_openingBook->TryGetBookMove(m_board, bestMove))
+    {
+        bestMove = m_gameAI->GetBestMove(m_board, maxDepth, maxTime);
+    }
 
     std::string result;
     if (m_board->TryGetMoveString(bestMove, result))
@@ -238,7 +341,7 @@ void Engine::BestMove()
     }
 }
 
-void Engine::Play(std::string args)
+void Engine::Play(std::string_view args)
 {
     if (!m_board)
     {
@@ -260,9 +363,9 @@ void Engine::Play(std::string args)
     }
     else
     {
-        std::ostringstream invalidMove;
-        invalidMove << InvalidMoveString << " " << InvalidMoveMessage_Generic;
-        WriteLine(invalidMove.str());
+        m_outputBuffer += InvalidMoveString;
+        m_outputBuffer += ' ';
+        WriteLine(InvalidMoveMessage_Generic);
     }
 
     WriteLine(OkString);
@@ -273,7 +376,7 @@ void Engine::Pass()
     Play(PassMoveString);
 }
 
-void Engine::Undo(std::string args)
+void Engine::Undo(std::string_view args)
 {
     if (!m_board)
     {
@@ -281,9 +384,8 @@ void Engine::Undo(std::string args)
         return;
     }
 
-    std::istringstream ss(args);
     int movesToUndo;
-    if ((ss >> movesToUndo).fail())
+    if (!TryParseInt(NextToken(args), movesToUndo))
     {
         movesToUndo = 1;
     }
@@ -308,7 +410,7 @@ void Engine::Options()
     WriteLine(OkString);
 }
 
-void Engine::Perft(std::string args)
+void Engine::Perft(std::string_view args)
 {
     if (!m_board)
     {
@@ -316,9 +418,8 @@ void Engine::Perft(std::string args)
         return;
     }
 
-    std::istringstream ss(args);
     int maxDepth;
-    if ((ss >> maxDepth).fail())
+    if (!TryParseInt(NextToken(args), maxDepth))
     {
         maxDepth = 0;
     }
@@ -329,6 +430,9 @@ void Engine::Perft(std::string args)
         return;
     }
 
+    StatCounts startStats;
+    GetStats(startStats);
+
     for (int depth = 0; depth <= maxDepth; depth++)
     {
         auto startTime = std::chrono::high_resolution_clock::now();
@@ -343,6 +447,91 @@ void Engine::Perft(std::string args)
         WriteLine(out.str());
     }
 
+    if (StatsEnabled)
+    {
+        // Only report what this perft counted
+        StatCounts stats;
+        GetStats(stats);
+        for (int i = 0; i < (int)StatCounter::NumStatCounters; i++)
+        {
+            stats[i] -= startStats[i];
+        }
+        WriteStats(stats);
+    }
+
+    WriteLine(OkString);
+}
+
+void Engine::Stats(std::string_view args)
+{
+    if (!m_processCommandsEnabled)
+    {
+        WriteError(ErrorMessage_ProcessCommandsDisabled);
+        return;
+    }
+
+    if (!StatsEnabled)
+    {
+        WriteError(ErrorMessage_StatsDisabled);
+        return;
+    }
+
+    if (args == StatsArg_Reset)
+    {
+        ResetStats();
+    }
+    else if (!args.empty())
+    {
+        WriteError(ErrorMessage_InvalidCommand);
+        return;
+    }
+
+    StatCounts stats;
+    GetStats(stats);
+    WriteStats(stats);
+
+    WriteLine(OkString);
+}
+
+void Engine::Trace(std::string_view args)
+{
+    if (!m_processCommandsEnabled)
+    {
+        WriteError(ErrorMessage_ProcessCommandsDisabled);
+        return;
+    }
+
+    if (!TracingSupported)
+    {
+        WriteError(ErrorMessage_TracingDisabled);
+        return;
+    }
+
+    auto arg = NextToken(args);
+    if (arg == TraceArg_Start && args.empty())
+    {
+        StartTracing();
+    }
+    else if (arg == TraceArg_Stop && args.empty())
+    {
+        StopTracing();
+    }
+    else if (arg == TraceArg_Dump && !args.empty())
+    {
+        // The rest of the line is the path, which may contain spaces
+        auto pathStart = args.find_first_not_of(' ');
+        if (!TryDumpTrace(std::string(args.substr(pathStart))))
+        {
+            WriteError(ErrorMessage_UnableToWriteTrace);
+            return;
+        }
+    }
+    else
+    {
+        WriteError(ErrorMessage_InvalidCommand);
+        return;
+    }
+
     WriteLine(OkString);
 }
 
@@ -0,0 +1,471 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#include <algorithm>
+
+#include "GameAI.h"
+#include "Trace.h"
+
+using namespace MzingaCpp;
+
+constexpr int InfiniteScore = 1000000;
+constexpr int WinScore = 100000;
+constexpr int DrawScore = 0;
+
+constexpr int QueenNeighborWeight = 50;
+constexpr int MobilePieceWeight = 5;
+
+constexpr int BestMoveOrderScore = 4000000;
+constexpr int KillerMoveOrderScore = 3000000;
+constexpr int CounterMoveOrderScore = 2000000;
+constexpr int MaxHistoryScore = 1000000;
+
+constexpr long NodesBetweenTimeChecks = 256;
+
+// History is indexed by destination (Q, R) wrapped to the low bits, which can't collide within a position, since
+// no hive is wide enough for destinations to differ by a multiple of the wrap
+constexpr int HistoryCellBits = 5;
+constexpr int HistoryCellMask = (1 << HistoryCellBits) - 1;
+constexpr int HistoryCellCount = 1 << (2 * HistoryCellBits);
+constexpr int HistorySize = (int)PieceName::NumPieceNames * HistoryCellCount;
+
+constexpr uint16_t NoCounterMove = UINT16_MAX;
+
+GameAI::GameAI() : m_history(HistorySize, 0), m_counterMoves(HistorySize, NoCounterMove)
+{
+    Reset();
+}
+
+void GameAI::Reset()
+{
+    for (int ply = 0; ply < MaxSearchPly; ply++)
+    {
+        for (int i = 0; i < NumKillerMoves; i++)
+        {
+            m_killerMoves[ply][i] = PassMove;
+        }
+    }
+
+    // Engines reset on every newgame, so skip clearing tables no search has written to since
+    if (m_historyUpdated)
+    {
+        std::fill(m_history.begin(), m_history.end(), 0);
+        std::fill(m_counterMoves.begin(), m_counterMoves.end(), NoCounterMove);
+        m_historyUpdated = false;
+    }
+}
+
+Move GameAI::GetBestMove(std::shared_ptr<Board> board, int maxDepth, std::chrono::milliseconds maxTime)
+{
+    int bestScore;
+    return GetBestMove(board, maxDepth, maxTime, bestScore);
+}
+
+Move GameAI::GetBestMove(std::shared_ptr<Board> board, int maxDepth, std::chrono::milliseconds maxTime, int &bestScore)
+{
+    // A non-positive time limit means search only limited by depth
+    m_deadline = maxTime.count() > 0 ? std::chrono::steady_clock::now() + maxTime
+                                     : std::chrono::steady_clock::time_point::max();
+    m_nodesSearched = 0;
+    m_searchAborted = false;
+
+    // Killers are position-specific, but history carries over (aged) between searches
+    for (int ply = 0; ply < MaxSearchPly; ply++)
+    {
+        for (int i = 0; i < NumKillerMoves; i++)
+        {
+            m_killerMoves[ply][i] = PassMove;
+        }
+    }
+
+    if (m_historyUpdated)
+    {
+        for (auto &value : m_history)
+        {
+            value /= 2;
+        }
+    }
+
+    auto validMoves = board->GetValidMoves();
+    Move bestMove = *(validMoves->begin());
+
+    // Scores are from the current color's perspective, falling back to a static evaluation
+    bestScore = Evaluate(board, 0);
+
+    if (validMoves->size() == 1)
+    {
+        return bestMove;
+    }
+
+    maxDepth = std::min(maxDepth, MaxSearchPly - 1);
+
+    for (int depth = 1; depth <= maxDepth; depth++)
+    {
+        MZINGACPP_TRACE_SCOPE("SearchIteration", "depth", depth);
+
+        auto moves = GetOrderedMoves(board, bestMove, 0);
+
+        int alpha = -InfiniteScore;
+        Move iterationBestMove = bestMove;
+
+        for (auto const &move : moves)
+        {
+            board->TrustedPlay(move, "");
+            int value = -Negamax(board, depth - 1, 1, -InfiniteScore, -alpha);
+            board->TryUndoLastMove();
+
+            if (m_searchAborted)
+            {
+                break;
+            }
+
+            if (value > alpha)
+            {
+                alpha = value;
+                iterationBestMove = move;
+            }
+        }
+
+        if (m_searchAborted)
+        {
+            // Only trust fully searched iterations
+            break;
+        }
+
+        bestMove = iterationBestMove;
+        bestScore = alpha;
+
+        if (alpha >= WinScore - MaxSearchPly || alpha <= -WinScore + MaxSearchPly)
+        {
+            // Result is forced, deeper searches won't change it
+            break;
+        }
+    }
+
+    return bestMove;
+}
+
+bool GameAI::TryGetMateMove(std::shared_ptr<Board> board, int maxMoves, std::chrono::milliseconds maxTime,
+                            Move &result)
+{
+    m_deadline = maxTime.count() > 0 ? std::chrono::steady_clock::now() + maxTime
+                                     : std::chrono::steady_clock::time_point::max();
+    m_nodesSearched = 0;
+    m_searchAborted = false;
+
+    // Look for the shortest forced queen surround first
+    for (int movesLeft = 1; movesLeft <= maxMoves; movesLeft++)
+    {
+        if (AttackerCanMate(board, movesLeft, result))
+        {
+            return true;
+        }
+
+        if (m_searchAborted)
+        {
+            break;
+        }
+    }
+
+    return false;
+}
+
+int GameAI::Negamax(std::shared_ptr<Board> board, int depth, int ply, int alpha, int beta)
+{
+    if (depth == 0 || ply >= MaxSearchPly - 1 || GameIsOver(board->GetBoardState()))
+    {
+        return Evaluate(board, ply);
+    }
+
+    if (SearchAborted())
+    {
+        return 0;
+    }
+
+    auto previousMove = board->GetLastMove();
+    auto moves = GetOrderedMoves(board, PassMove, ply);
+
+    int bestValue = -InfiniteScore;
+
+    for (auto const &move : moves)
+    {
+        board->TrustedPlay(move, "");
+        int value = -Negamax(board, depth - 1, ply + 1, -beta, -alpha);
+        board->TryUndoLastMove();
+
+        if (m_searchAborted)
+        {
+            return 0;
+        }
+
+        if (value > bestValue)
+        {
+            bestValue = value;
+        }
+
+        if (value > alpha)
+        {
+            alpha = value;
+        }
+
+        if (alpha >= beta)
+        {
+            UpdateMoveOrdering(move, previousMove, depth, ply);
+            break;
+        }
+    }
+
+    return bestValue;
+}
+
+int GameAI::Evaluate(std::shared_ptr<Board> board, int ply)
+{
+    auto boardState = board->GetBoardState();
+    auto currentColor = board->GetCurrentColor();
+
+    if (boardState == BoardState::Draw)
+    {
+        return DrawScore;
+    }
+    else if (boardState == BoardState::WhiteWins || boardState == BoardState::BlackWins)
+    {
+        // Prefer faster wins and slower losses
+        bool currentColorWins = (boardState == BoardState::WhiteWins) == (currentColor == Color::White);
+        return currentColorWins ? WinScore - ply : -(WinScore - ply);
+    }
+
+    auto ownQueen = currentColor == Color::White ? PieceName::wQ : PieceName::bQ;
+    auto opponentQueen = currentColor == Color::White ? PieceName::bQ : PieceName::wQ;
+
+    int score = QueenNeighborWeight * (board->CountNeighbors(opponentQueen) - board->CountNeighbors(ownQueen));
+
+    for (int pn = 0; pn < (int)PieceName::NumPieceNames; pn++)
+    {
+        auto pieceName = (PieceName)pn;
+        if (board->PieceIsOnTop(pieceName) && board->CanMoveWithoutBreakingHive(pieceName))
+        {
+            score += GetColor(pieceName) == currentColor ? MobilePieceWeight : -MobilePieceWeight;
+        }
+    }
+
+    return score;
+}
+
+std::vector<Move> GameAI::GetOrderedMoves(std::shared_ptr<Board> board, Move const &bestMove, int ply)
+{
+    auto validMoves = board->GetValidMoves();
+    auto previousMove = board->GetLastMove();
+
+    uint16_t counterMove = NoCounterMove;
+    if (previousMove != PassMove)
+    {
+        counterMove = m_counterMoves[GetHistoryIndex(previousMove)];
+    }
+
+    std::vector<std::pair<int, Move>> scoredMoves;
+    scoredMoves.reserve(validMoves->size());
+
+    for (auto const &move : *validMoves)
+    {
+        int score = 0;
+        if (move == bestMove)
+        {
+            score = BestMoveOrderScore;
+        }
+        else if (move == m_killerMoves[ply][0])
+        {
+            score = KillerMoveOrderScore;
+        }
+        else if (move == m_killerMoves[ply][1])
+        {
+            score = KillerMoveOrderScore - 1;
+        }
+        else if (move != PassMove)
+        {
+            // A piece and its destination are enough to identify a move within a position
+            int historyIndex = GetHistoryIndex(move);
+            score = historyIndex == counterMove ? CounterMoveOrderScore : m_history[historyIndex];
+        }
+        scoredMoves.push_back(std::make_pair(score, move));
+    }
+
+    std::stable_sort(scoredMoves.begin(), scoredMoves.end(),
+                     [](std::pair<int, Move> const &lhs, std::pair<int, Move> const &rhs) {
+                         return lhs.first > rhs.first;
+                     });
+
+    std::vector<Move> moves;
+    moves.reserve(scoredMoves.size());
+    for (auto const &iter : scoredMoves)
+    {
+        moves.push_back(iter.second);
+    }
+
+    return moves;
+}
+
+void GameAI::UpdateMoveOrdering(Move const &move, Move const &previousMove, int depth, int ply)
+{
+    if (move == PassMove)
+    {
+        return;
+    }
+
+    if (m_killerMoves[ply][0] != move)
+    {
+        for (int i = NumKillerMoves - 1; i > 0; i--)
+        {
+            m_killerMoves[ply][i] = m_killerMoves[ply][i - 1];
+        }
+        m_killerMoves[ply][0] = move;
+    }
+
+    m_historyUpdated = true;
+
+    auto &historyValue = m_history[GetHistoryIndex(move)];
+    historyValue += depth * depth;
+    if (historyValue > MaxHistoryScore)
+    {
+        for (auto &value : m_history)
+        {
+            value /= 2;
+        }
+    }
+
+    if (previousMove != PassMove)
+    {
+        m_counterMoves[GetHistoryIndex(previousMove)] = (uint16_t)GetHistoryIndex(move);
+    }
+}
+
+int GameAI::GetHistoryIndex(Move const &move)
+{
+    // Butterfly index: piece x wrapped destination cell, ignoring stack height
+    int cell = ((move.Destination.Q & HistoryCellMask) << HistoryCellBits) | (move.Destination.R & HistoryCellMask);
+    return (int)move.PieceName * HistoryCellCount + cell;
+}
+
+bool GameAI::SearchAborted()
+{
+    if (!m_searchAborted && ++m_nodesSearched % NodesBetweenTimeChecks == 0)
+    {
+        m_searchAborted = std::chrono::steady_clock::now() >= m_deadline;
+    }
+
+    return m_searchAborted;
+}
+
+bool GameAI::AttackerCanMate(std::shared_ptr<Board> board, int movesLeft, Move &mateMove)
+{
+    auto attackerColor = board->GetCurrentColor();
+    auto defenderQueen = attackerColor == Color::White ? PieceName::bQ : PieceName::wQ;
+    auto attackerWins = attackerColor == Color::White ? BoardState::WhiteWins : BoardState::BlackWins;
+
+    // There's no cheap bound on how far the queen is from being surrounded, since one move can add several
+    // neighbors, e.g. the queen walking into a pocket or being thrown by a pillbug
+    if (!board->PieceInPlay(defenderQueen))
+    {
+        return false;
+    }
+
+    // Out of time means no mate was found, and unwinds without trusting anything still being searched
+    if (SearchAborted())
+    {
+        return false;
+    }
+
+    for (auto const &move : GetMateCandidateMoves(board))
+    {
+        board->TrustedPlay(move, "");
+
+        bool mates = board->GetBoardState() == attackerWins ||
+                     (movesLeft > 1 && GameInProgress(board->GetBoardState()) && DefenderIsMated(board, movesLeft - 1));
+
+        board->TryUndoLastMove();
+
+        if (m_searchAborted)
+        {
+            return false;
+        }
+
+        if (mates)
+        {
+            mateMove = move;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool GameAI::DefenderIsMated(std::shared_ptr<Board> board, int movesLeft)
+{
+    auto defenderColor = board->GetCurrentColor();
+    auto attackerWins = defenderColor == Color::White ? BoardState::BlackWins : BoardState::WhiteWins;
+
+    if (SearchAborted())
+    {
+        return false;
+    }
+
+    auto validMoves = board->GetValidMoves();
+
+    for (auto const &move : *validMoves)
+    {
+        board->TrustedPlay(move, "");
+
+        // A reply that surrounds the defender's own queen loses outright
+        auto state = board->GetBoardState();
+        Move mateMove;
+        bool mated = state == attackerWins || (GameInProgress(state) && AttackerCanMate(board, movesLeft, mateMove));
+
+        board->TryUndoLastMove();
+
+        if (!mated || m_searchAborted)
+        {
+            // Defender has an escape, including drawing or winning outright, or there was no time to search one
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::vector<Move> GameAI::GetMateCandidateMoves(std::shared_ptr<Board> board)
+{
+    auto attackerColor = board->GetCurrentColor();
+    auto attackerQueen = attackerColor == Color::White ? PieceName::wQ : PieceName::bQ;
+    auto defenderQueen = attackerColor == Color::White ? PieceName::bQ : PieceName::wQ;
+
+    int defenderQueenNeighbors = board->CountNeighbors(defenderQueen);
+    int attackerQueenNeighbors = board->CountNeighbors(attackerQueen);
+
+    // Only free our own queen when it's one neighbor away from being surrounded
+    bool attackerQueenThreatened = attackerQueenNeighbors >= (int)Direction::NumDirections - 1;
+
+    std::vector<Move> candidates;
+
+    auto validMoves = board->GetValidMoves();
+    for (auto const &move : *validMoves)
+    {
+        if (move == PassMove)
+        {
+            continue;
+        }
+
+        board->TrustedPlay(move, "");
+
+        if (board->CountNeighbors(defenderQueen) > defenderQueenNeighbors)
+        {
+            candidates.insert(candidates.begin(), move);
+        }
+        else if (attackerQueenThreatened && board->CountNeighbors(attackerQueen) < attackerQueenNeighbors)
+        {
+            candidates.push_back(move);
+        }
+
+        board->TryUndoLastMove();
+    }
+
+    return candidates;
+}
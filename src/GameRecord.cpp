@@ -0,0 +1,169 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#include <cstring>
+
+#include "Constants.h"
+#include "GameRecord.h"
+
+using namespace MzingaCpp;
+
+// Stands in for PieceName::INVALID, i.e. the moving piece of a pass or the target piece of the first move
+constexpr int NoPackedPiece = 0x1F;
+
+inline PackedMove PackMove(PieceName const &pieceName, PieceName const &targetPieceName, Direction const &direction)
+{
+    int piece = pieceName != PieceName::INVALID ? (int)pieceName : NoPackedPiece;
+    int targetPiece = targetPieceName != PieceName::INVALID ? (int)targetPieceName : NoPackedPiece;
+    return (PackedMove)(piece | (targetPiece << 5) | ((int)direction << 10));
+}
+
+inline void UnpackMove(PackedMove const &packedMove, int &piece, int &targetPiece, int &direction)
+{
+    piece = packedMove & 0x1F;
+    targetPiece = (packedMove >> 5) & 0x1F;
+    direction = (packedMove >> 10) & 0x7;
+}
+
+GameRecordWriter::GameRecordWriter(std::ostream &output) : m_output(output)
+{
+}
+
+bool GameRecordWriter::TryWrite(std::string_view gameString)
+{
+    // Only write games that replay cleanly, so that readers can trust every move
+    std::shared_ptr<Board> board;
+    if (!Board::TryParseGameString(gameString, board))
+    {
+        return false;
+    }
+
+    GameRecordHeader header;
+    header.BoardState = (int8_t)board->GetBoardState();
+
+    m_moves.clear();
+
+    int itemIndex = 0;
+    while (!gameString.empty())
+    {
+        auto tokenLength = gameString.find(';');
+        auto token = gameString.substr(0, tokenLength);
+        gameString.remove_prefix(tokenLength != std::string_view::npos ? tokenLength + 1 : gameString.length());
+
+        if (!token.empty())
+        {
+            if (itemIndex == 0)
+            {
+                header.GameType = (int8_t)GetGameTypeValue(token);
+            }
+            else if (itemIndex > 2)
+            {
+                bool isPass;
+                PieceName startPiece;
+                char beforeSeperator;
+                PieceName endPiece;
+                char afterSeperator;
+                TryNormalizeMoveString(token, isPass, startPiece, beforeSeperator, endPiece, afterSeperator);
+
+                m_moves.push_back(PackMove(startPiece, endPiece, GetTargetDirection(beforeSeperator, afterSeperator)));
+            }
+
+            itemIndex++;
+        }
+    }
+
+    if (m_moves.size() > UINT16_MAX)
+    {
+        return false;
+    }
+
+    header.MoveCount = (uint16_t)m_moves.size();
+
+    if (!m_fileHeaderWritten)
+    {
+        GameRecordFileHeader fileHeader;
+        memcpy(fileHeader.Magic, GameRecordMagic, sizeof(fileHeader.Magic));
+        fileHeader.Version = GameRecordVersion;
+
+        m_output.write((char const *)&fileHeader, sizeof(fileHeader));
+        m_fileHeaderWritten = true;
+    }
+
+    m_output.write((char const *)&header, sizeof(header));
+    m_output.write((char const *)m_moves.data(), m_moves.size() * sizeof(PackedMove));
+
+    return (bool)m_output;
+}
+
+GameRecordReader::GameRecordReader(std::istream &input) : m_input(input)
+{
+}
+
+bool GameRecordReader::TryReadNext(std::shared_ptr<Board> &result)
+{
+    if (!m_fileHeaderRead)
+    {
+        GameRecordFileHeader fileHeader;
+        if (!m_input.read((char *)&fileHeader, sizeof(fileHeader)) ||
+            memcmp(fileHeader.Magic, GameRecordMagic, sizeof(fileHeader.Magic)) != 0 ||
+            fileHeader.Version != GameRecordVersion)
+        {
+            return false;
+        }
+        m_fileHeaderRead = true;
+    }
+
+    GameRecordHeader header;
+    if (!m_input.read((char *)&header, sizeof(header)) || header.GameType < (int)GameType::Base ||
+        header.GameType > (int)GameType::BaseMLP)
+    {
+        return false;
+    }
+
+    m_moves.resize(header.MoveCount);
+    if (!m_input.read((char *)m_moves.data(), m_moves.size() * sizeof(PackedMove)))
+    {
+        return false;
+    }
+
+    auto board = std::make_shared<Board>((GameType)header.GameType);
+
+    for (auto const &packedMove : m_moves)
+    {
+        int piece, targetPiece, direction;
+        UnpackMove(packedMove, piece, targetPiece, direction);
+
+        Move move = PassMove;
+        if (piece != NoPackedPiece)
+        {
+            if (piece >= (int)PieceName::NumPieceNames ||
+                !PieceNameIsEnabledForGameType((PieceName)piece, (GameType)header.GameType) ||
+                (targetPiece != NoPackedPiece && targetPiece >= (int)PieceName::NumPieceNames) ||
+                direction > (int)Direction::Above)
+            {
+                return false;
+            }
+
+            auto targetPieceName = targetPiece != NoPackedPiece ? (PieceName)targetPiece : PieceName::INVALID;
+            if (!board->TryGetMove((PieceName)piece, targetPieceName, (Direction)direction, move) ||
+                move.Destination.Stack >= BoardStackSize)
+            {
+                return false;
+            }
+        }
+
+        // Moves only decode to a piece and target, so corrupt or hostile records can still hold illegal moves
+        if (!board->TryPlayMove(move, ""))
+        {
+            return false;
+        }
+    }
+
+    if ((int)board->GetBoardState() != header.BoardState)
+    {
+        return false;
+    }
+
+    result = board;
+    return true;
+}
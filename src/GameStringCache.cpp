@@ -0,0 +1,110 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#include "GameStringCache.h"
+
+using namespace MzingaCpp;
+
+GameStringCache::GameStringCache(size_t capacity) : m_capacity(capacity > 0 ? capacity : 1)
+{
+}
+
+bool GameStringCache::TryParseGameString(std::string_view gameString, std::shared_ptr<Board> &result)
+{
+    // Split into the same tokens as Board::TryParseGameString, skipping the state and turn
+    GameType gameType = GameType::INVALID;
+    std::string key;
+    std::vector<std::string_view> moveTokens;
+
+    int itemIndex = 0;
+    while (!gameString.empty())
+    {
+        auto tokenLength = gameString.find(';');
+        auto token = gameString.substr(0, tokenLength);
+        gameString.remove_prefix(tokenLength != std::string_view::npos ? tokenLength + 1 : gameString.length());
+
+        if (!token.empty())
+        {
+            if (itemIndex == 0)
+            {
+                gameType = GetGameTypeValue(token);
+                key = token;
+            }
+            else if (itemIndex > 2)
+            {
+                key += ';';
+                key += token;
+                moveTokens.push_back(token);
+            }
+
+            itemIndex++;
+        }
+    }
+
+    if (gameType == GameType::INVALID)
+    {
+        return false;
+    }
+
+    // Find the longest cached game that this one starts with
+    auto cached = m_entries.end();
+    for (auto entry = m_entries.begin(); entry != m_entries.end(); entry++)
+    {
+        auto length = entry->Key.length();
+        if (length <= key.length() && (length == key.length() || key[length] == ';') &&
+            key.compare(0, length, entry->Key) == 0 && (cached == m_entries.end() || length > cached->Key.length()))
+        {
+            cached = entry;
+        }
+    }
+
+    auto board = std::make_shared<Board>(gameType);
+
+    Entry newEntry;
+    if (cached != m_entries.end())
+    {
+        // These moves were all valid when the cached game was loaded
+        for (size_t i = 0; i < cached->Moves.size(); i++)
+        {
+            board->TrustedPlay(cached->Moves[i], cached->MoveStrings[i]);
+        }
+
+        m_entries.splice(m_entries.begin(), m_entries, cached);
+
+        if (cached->Moves.size() == moveTokens.size())
+        {
+            result = board;
+            return true;
+        }
+
+        newEntry.Moves = cached->Moves;
+        newEntry.MoveStrings = cached->MoveStrings;
+    }
+
+    for (size_t i = newEntry.Moves.size(); i < moveTokens.size(); i++)
+    {
+        Move move;
+        std::string moveString;
+        if (!board->TryParseMove(moveTokens[i], move, moveString) || !board->TryPlayMove(move, moveString))
+        {
+            return false;
+        }
+
+        newEntry.Moves.push_back(move);
+        newEntry.MoveStrings.push_back(std::move(moveString));
+    }
+
+    if (!moveTokens.empty())
+    {
+        newEntry.Key = std::move(key);
+        m_entries.push_front(std::move(newEntry));
+
+        if (m_entries.size() > m_capacity)
+        {
+            m_entries.pop_back();
+        }
+    }
+
+    result = board;
+    return true;
+}
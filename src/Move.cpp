@@ -1,8 +1,6 @@
 // Copyright (c) Jon Thysell <http://jonthysell.com>
 // Licensed under the MIT License.
 
-#include <cstring>
-#include <sstream>
 #include <string>
 
 #include "Constants.h"
@@ -37,31 +35,65 @@ std::string BuildMoveString(bool &isPass, PieceName &startPiece, char &beforeSep
         return PassMoveString;
     }
 
-    std::ostringstream resultStream;
-
-    resultStream << GetEnumString(startPiece);
+    // Longest move string is "wA1 -bA1", which fits in the small string buffer
+    std::string result(GetEnumStringView(startPiece));
 
     if (endPiece != PieceName::INVALID)
     {
-        resultStream << " ";
+        result += ' ';
         if (beforeSeperator != '\0')
         {
-            resultStream << beforeSeperator << GetEnumString(endPiece);
+            result += beforeSeperator;
+            result += GetEnumStringView(endPiece);
         }
         else if (afterSeperator != '\0')
         {
-            resultStream << GetEnumString(endPiece) << afterSeperator;
+            result += GetEnumStringView(endPiece);
+            result += afterSeperator;
         }
         else
         {
-            resultStream << GetEnumString(endPiece);
+            result += GetEnumStringView(endPiece);
+        }
+    }
+
+    return result;
+}
+
+Direction GetTargetDirection(char const &beforeSeperator, char const &afterSeperator)
+{
+    if (beforeSeperator != '\0')
+    {
+        // Moving piece on the left-hand side of the target piece
+        switch (beforeSeperator)
+        {
+        case '-':
+            return Direction::UpLeft;
+        case '/':
+            return Direction::DownLeft;
+        case '\\':
+            return Direction::Up;
+        }
+    }
+    else if (afterSeperator != '\0')
+    {
+        // Moving piece on the right-hand side of the target piece
+        switch (afterSeperator)
+        {
+        case '-':
+            return Direction::DownRight;
+        case '/':
+            return Direction::UpRight;
+        case '\\':
+            return Direction::Down;
         }
     }
 
-    return resultStream.str();
+    // Moving piece on top of the target piece
+    return Direction::Above;
 }
 
-bool TryNormalizeMoveString(std::string const &moveString, std::string &result)
+bool TryNormalizeMoveString(std::string_view moveString, std::string &result)
 {
     bool isPass;
     PieceName startPiece;
@@ -79,7 +111,7 @@ bool TryNormalizeMoveString(std::string const &moveString, std::string &result)
     return false;
 }
 
-bool TryNormalizeMoveString(std::string const &moveString, bool &isPass, PieceName &startPiece, char &beforeSeperator,
+bool TryNormalizeMoveString(std::string_view moveString, bool &isPass, PieceName &startPiece, char &beforeSeperator,
                             PieceName &endPiece, char &afterSeperator)
 {
     isPass = false;
@@ -88,16 +120,20 @@ bool TryNormalizeMoveString(std::string const &moveString, bool &isPass, PieceNa
     endPiece = PieceName::INVALID;
     afterSeperator = '\0';
 
-    std::ostringstream piece1;
-    std::ostringstream piece2;
+    // Both pieces are slices of moveString, so nothing is copied
+    size_t piece1Start = 0;
+    size_t piece1Length = 0;
+    size_t piece2Start = 0;
+    size_t piece2Length = 0;
 
     int itemsFound = 0;
-    for (int i = 0; i < moveString.length(); i++)
+    for (size_t i = 0; i < moveString.length(); i++)
     {
         if (itemsFound == 0 && moveString[i] != ' ')
         {
             // Start of piece1, save and bump
-            piece1 << moveString[i];
+            piece1Start = i;
+            piece1Length = 1;
             itemsFound++;
         }
         else if (itemsFound == 1)
@@ -105,7 +141,7 @@ bool TryNormalizeMoveString(std::string const &moveString, bool &isPass, PieceNa
             if (moveString[i] != ' ')
             {
                 // Still part of piece1
-                piece1 << moveString[i];
+                piece1Length++;
             }
             else
             {
@@ -122,11 +158,13 @@ bool TryNormalizeMoveString(std::string const &moveString, bool &isPass, PieceNa
                 {
                     // beforeSeparator found
                     beforeSeperator = moveString[i];
+                    piece2Start = i + 1;
                 }
                 else
                 {
                     // Start of piece2
-                    piece2 << moveString[i];
+                    piece2Start = i;
+                    piece2Length = 1;
                 }
                 itemsFound++;
             }
@@ -144,7 +182,7 @@ bool TryNormalizeMoveString(std::string const &moveString, bool &isPass, PieceNa
                 else
                 {
                     // Still of piece2
-                    piece2 << moveString[i];
+                    piece2Length++;
                 }
             }
             else
@@ -154,9 +192,9 @@ bool TryNormalizeMoveString(std::string const &moveString, bool &isPass, PieceNa
         }
     }
 
-    std::string piece1Str = piece1.str();
+    auto piece1 = moveString.substr(piece1Start, piece1Length);
 
-    if (strcmp(piece1Str.c_str(), PassMoveString) == 0)
+    if (piece1 == PassMoveString)
     {
         isPass = true;
         startPiece = PieceName::INVALID;
@@ -166,15 +204,14 @@ bool TryNormalizeMoveString(std::string const &moveString, bool &isPass, PieceNa
         return true;
     }
 
-    startPiece = GetPieceNameValue(piece1Str.c_str());
+    startPiece = GetPieceNameValue(piece1);
 
     if (startPiece != PieceName::INVALID)
     {
-        std::string piece2Str = piece2.str();
-        endPiece = GetPieceNameValue(piece2Str.c_str());
+        auto piece2 = moveString.substr(piece2Start, piece2Length);
+        endPiece = GetPieceNameValue(piece2);
 
-        if ((strcmp(piece2Str.c_str(), "") == 0 && beforeSeperator == '\0' && afterSeperator == '\0')
-            || endPiece != PieceName::INVALID)
+        if ((piece2.empty() && beforeSeperator == '\0' && afterSeperator == '\0') || endPiece != PieceName::INVALID)
         {
             return true;
         }
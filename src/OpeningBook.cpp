@@ -0,0 +1,183 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Constants.h"
+#include "OpeningBook.h"
+
+using namespace MzingaCpp;
+
+OpeningBook::~OpeningBook()
+{
+    Unload();
+}
+
+bool OpeningBook::TryLoad(std::string const &path)
+{
+    Unload();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(OpeningBookHeader))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (fileMapping == nullptr)
+    {
+        return false;
+    }
+
+    void *data = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr)
+    {
+        CloseHandle(fileMapping);
+        return false;
+    }
+
+    m_fileMapping = fileMapping;
+    m_mappedData = data;
+    m_mappedSize = (size_t)fileSize.QuadPart;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t)sizeof(OpeningBookHeader))
+    {
+        close(fd);
+        return false;
+    }
+
+    // Map read-only and shared so that every engine process uses the same page cache
+    void *data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_mappedData = data;
+    m_mappedSize = (size_t)fileStat.st_size;
+#endif
+
+    auto header = (OpeningBookHeader const *)m_mappedData;
+    if (memcmp(header->Magic, OpeningBookMagic, sizeof(header->Magic)) != 0 ||
+        header->Version != OpeningBookVersion ||
+        header->EntryCount > (m_mappedSize - sizeof(OpeningBookHeader)) / sizeof(OpeningBookEntry))
+    {
+        Unload();
+        return false;
+    }
+
+    m_entries = (OpeningBookEntry const *)((char const *)m_mappedData + sizeof(OpeningBookHeader));
+    m_entryCount = header->EntryCount;
+
+    return true;
+}
+
+void OpeningBook::Unload()
+{
+    if (m_mappedData != nullptr)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(m_mappedData);
+        CloseHandle((HANDLE)m_fileMapping);
+        m_fileMapping = nullptr;
+#else
+        munmap(m_mappedData, m_mappedSize);
+#endif
+    }
+
+    m_mappedData = nullptr;
+    m_mappedSize = 0;
+    m_entries = nullptr;
+    m_entryCount = 0;
+}
+
+bool OpeningBook::TryGetBookMove(std::shared_ptr<Board> board, Move &result)
+{
+    if (!IsLoaded() || board->GetCurrentTurn() >= MaxOpeningBookTurns)
+    {
+        return false;
+    }
+
+    auto key = board->GetZobristKey();
+
+    auto end = m_entries + m_entryCount;
+    auto it = std::lower_bound(m_entries, end, key,
+                               [](OpeningBookEntry const &entry, uint64_t key) { return entry.Key < key; });
+
+    if (it == end || it->Key != key)
+    {
+        return false;
+    }
+
+    auto validMoves = board->GetValidMoves();
+
+    // Entries for a key are sorted by descending weight, so take the first one that's valid
+    for (; it != end && it->Key == key; it++)
+    {
+        for (auto const &move : *validMoves)
+        {
+            if ((int)move.PieceName == it->PieceName && move.Destination.Q == it->Q && move.Destination.R == it->R &&
+                move.Destination.Stack == it->Stack)
+            {
+                result = move;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool OpeningBook::TryWrite(std::string const &path, std::vector<OpeningBookEntry> entries)
+{
+    std::sort(entries.begin(), entries.end(), [](OpeningBookEntry const &lhs, OpeningBookEntry const &rhs) {
+        return lhs.Key != rhs.Key ? lhs.Key < rhs.Key : lhs.Weight > rhs.Weight;
+    });
+
+    OpeningBookHeader header;
+    memcpy(header.Magic, OpeningBookMagic, sizeof(header.Magic));
+    header.Version = OpeningBookVersion;
+    header.EntryCount = entries.size();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        return false;
+    }
+
+    out.write((char const *)&header, sizeof(header));
+    out.write((char const *)entries.data(), entries.size() * sizeof(OpeningBookEntry));
+
+    return (bool)out;
+}
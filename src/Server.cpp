@@ -0,0 +1,502 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#include "Server.h"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Constants.h"
+#include "OpeningBook.h"
+
+namespace MzingaCpp
+{
+struct ServerSession
+{
+    int Fd;
+    std::unique_ptr<Engine> SessionEngine;
+
+    // Only the thread running the engine writes this, and it's handed back with the finished job
+    std::string EngineOutput;
+
+    std::string Input;
+    std::string Output;
+    size_t OutputStart = 0;
+
+    // What epoll is waiting for, where none means the session's been taken out of the epoll set
+    uint32_t Events = 0;
+
+    bool Busy = false;
+    bool InputClosed = false;
+};
+
+Server::Server(int numThreads) : m_numThreads(numThreads > 0 ? numThreads : 1)
+{
+}
+
+Server::~Server()
+{
+    StopWorkers();
+
+    for (auto fd : {m_epollFd, m_listenFd, m_jobsDoneFd, m_signalFd})
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+}
+
+bool Server::TryLoadOpeningBook(std::string const &path)
+{
+    // Every session maps the book itself, so only check that it loads here
+    OpeningBook openingBook;
+    if (!openingBook.TryLoad(path))
+    {
+        return false;
+    }
+
+    m_bookPath = path;
+    return true;
+}
+
+bool Server::Run(std::string const &socketPath)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.length() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Socket path is too long: " << socketPath << std::endl;
+        return false;
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.length() + 1);
+
+    // Block the shutdown signals before starting any threads, so they're only read from the signalfd
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    m_jobsDoneFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (m_epollFd < 0 || m_listenFd < 0 || m_jobsDoneFd < 0 || m_signalFd < 0)
+    {
+        std::cerr << "Unable to start server: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Replace a socket left behind by a previous server, but never anything else that's at the path
+    struct stat pathStat;
+    if (lstat(socketPath.c_str(), &pathStat) == 0)
+    {
+        if (!S_ISSOCK(pathStat.st_mode))
+        {
+            std::cerr << "Unable to listen on " << socketPath << ": " << strerror(EADDRINUSE) << std::endl;
+            return false;
+        }
+        unlink(socketPath.c_str());
+    }
+
+    if (bind(m_listenFd, (sockaddr *)&address, sizeof(address)) != 0 || listen(m_listenFd, ServerListenBacklog) != 0)
+    {
+        std::cerr << "Unable to listen on " << socketPath << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    for (auto fd : {m_listenFd, m_jobsDoneFd, m_signalFd})
+    {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    for (int i = 0; i < m_numThreads; i++)
+    {
+        m_workers.emplace_back(&Server::RunJobs, this);
+    }
+
+    epoll_event events[ServerMaxEvents];
+    bool running = true;
+    while (running)
+    {
+        int numEvents = epoll_wait(m_epollFd, events, ServerMaxEvents, -1);
+        if (numEvents < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        for (int i = 0; i < numEvents; i++)
+        {
+            int fd = events[i].data.fd;
+            if (fd == m_listenFd)
+            {
+                AcceptSessions();
+            }
+            else if (fd == m_jobsDoneFd)
+            {
+                FinishJobs();
+            }
+            else if (fd == m_signalFd)
+            {
+                running = false;
+            }
+            else
+            {
+                // An earlier event in this batch may have closed the session
+                auto session = m_sessions.find(fd);
+                if (session == m_sessions.end())
+                {
+                    continue;
+                }
+
+                auto sessionPtr = session->second;
+                if ((events[i].events & EPOLLOUT) != 0)
+                {
+                    WriteSession(sessionPtr);
+                }
+
+                if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0 && sessionPtr->Fd >= 0)
+                {
+                    ReadSession(sessionPtr);
+                }
+            }
+        }
+    }
+
+    StopWorkers();
+
+    while (!m_sessions.empty())
+    {
+        CloseSession(m_sessions.begin()->second);
+    }
+
+    unlink(socketPath.c_str());
+
+    return true;
+}
+
+void Server::AcceptSessions()
+{
+    while (true)
+    {
+        int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        auto session = std::make_shared<ServerSession>();
+        session->Fd = fd;
+
+        auto sessionPtr = session.get();
+        session->SessionEngine = std::make_unique<Engine>(
+            [sessionPtr](std::string_view engineOutput) { sessionPtr->EngineOutput += engineOutput; });
+
+        // Clients mustn't be able to write trace files or change what other sessions see
+        session->SessionEngine->DisableProcessCommands();
+
+        if (!m_bookPath.empty())
+        {
+            session->SessionEngine->TryLoadOpeningBook(m_bookPath);
+        }
+
+        m_sessions[fd] = session;
+
+        session->SessionEngine->Start();
+        session->Output.swap(session->EngineOutput);
+        WriteSession(session);
+    }
+}
+
+void Server::ReadSession(std::shared_ptr<ServerSession> const &session)
+{
+    // Leave input beyond the limit in the socket until the session's caught up, so a client can't make the
+    // server buffer unlimited input while it's busy
+    char buffer[ServerReadBufferSize];
+    while (session->Input.length() < ServerMaxInputLength)
+    {
+        auto bytesRead = read(session->Fd, buffer, sizeof(buffer));
+        if (bytesRead > 0)
+        {
+            session->Input.append(buffer, bytesRead);
+        }
+        else if (bytesRead < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            // Stop reading on end of input or an error, but still run whatever commands already arrived
+            if (bytesRead == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+            {
+                session->InputClosed = true;
+            }
+            break;
+        }
+    }
+
+    if (session->Input.length() >= ServerMaxInputLength && session->Input.find('\n') == std::string::npos)
+    {
+        CloseSession(session);
+        return;
+    }
+
+    RunCommands(session);
+}
+
+// Runs the session's complete lines, up to the first one that needs a worker
+void Server::RunCommands(std::shared_ptr<ServerSession> const &session)
+{
+    auto &engine = *session->SessionEngine;
+
+    size_t lineStart = 0;
+    while (!session->Busy && !engine.ExitRequested())
+    {
+        // Once the client's done sending, the last line doesn't need to end with a newline
+        auto lineEnd = session->Input.find('\n', lineStart);
+        if (lineEnd == std::string::npos)
+        {
+            if (!session->InputClosed || lineStart == session->Input.length())
+            {
+                break;
+            }
+            lineEnd = session->Input.length();
+        }
+
+        std::string_view line{session->Input.data() + lineStart, lineEnd - lineStart};
+        lineStart = std::min(lineEnd + 1, session->Input.length());
+
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+
+        auto command = line.substr(0, line.find(' '));
+        if (command == CommandString_BestMove || command == CommandString_Perft)
+        {
+            session->Busy = true;
+            {
+                std::lock_guard<std::mutex> lock(m_jobsMutex);
+                m_pendingJobs.push_back(Job{session, std::string(line)});
+            }
+            m_jobsReady.notify_one();
+        }
+        else
+        {
+            engine.ReadLine(line);
+            session->Output += session->EngineOutput;
+            session->EngineOutput.clear();
+        }
+    }
+
+    session->Input.erase(0, lineStart);
+
+    WriteSession(session);
+}
+
+void Server::WriteSession(std::shared_ptr<ServerSession> const &session)
+{
+    while (session->OutputStart < session->Output.length())
+    {
+        auto bytesWritten = send(session->Fd, session->Output.data() + session->OutputStart,
+                                 session->Output.length() - session->OutputStart, MSG_NOSIGNAL);
+        if (bytesWritten > 0)
+        {
+            session->OutputStart += bytesWritten;
+        }
+        else if (bytesWritten < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (bytesWritten < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        else
+        {
+            // The client's gone, so drop anything else it was sent
+            session->InputClosed = true;
+            session->Output.clear();
+            session->OutputStart = 0;
+            break;
+        }
+    }
+
+    if (session->OutputStart == session->Output.length())
+    {
+        session->Output.clear();
+        session->OutputStart = 0;
+    }
+
+    // Close once the client's done and has everything it was sent
+    if (!session->Busy && session->Output.empty() &&
+        (session->InputClosed || session->SessionEngine->ExitRequested()))
+    {
+        CloseSession(session);
+        return;
+    }
+
+    UpdateSessionEvents(session);
+}
+
+// Waits for input unless the client's done sending or has sent as much as can be buffered, and for room
+// to write if output is backed up. A session waiting on neither leaves the epoll set, since hangups are
+// reported whatever it waits for.
+void Server::UpdateSessionEvents(std::shared_ptr<ServerSession> const &session)
+{
+    bool wantsInput = !session->InputClosed && session->Input.length() < ServerMaxInputLength;
+    uint32_t events = (wantsInput ? (uint32_t)EPOLLIN : 0) | (session->Output.empty() ? 0 : (uint32_t)EPOLLOUT);
+    if (events != session->Events)
+    {
+        int op = EPOLL_CTL_MOD;
+        if (events == 0)
+        {
+            op = EPOLL_CTL_DEL;
+        }
+        else if (session->Events == 0)
+        {
+            op = EPOLL_CTL_ADD;
+        }
+
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = session->Fd;
+        epoll_ctl(m_epollFd, op, session->Fd, &event);
+        session->Events = events;
+    }
+}
+
+void Server::CloseSession(std::shared_ptr<ServerSession> const &session)
+{
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, session->Fd, nullptr);
+    close(session->Fd);
+    m_sessions.erase(session->Fd);
+
+    // A busy session stays alive until its worker's done with it, and is then dropped
+    session->Fd = -1;
+}
+
+void Server::FinishJobs()
+{
+    uint64_t count;
+    while (read(m_jobsDoneFd, &count, sizeof(count)) > 0)
+    {
+    }
+
+    std::vector<std::shared_ptr<ServerSession>> finishedJobs;
+    {
+        std::lock_guard<std::mutex> lock(m_jobsMutex);
+        finishedJobs.swap(m_finishedJobs);
+    }
+
+    for (auto const &session : finishedJobs)
+    {
+        session->Busy = false;
+        if (session->Fd >= 0)
+        {
+            session->Output += session->EngineOutput;
+            session->EngineOutput.clear();
+            RunCommands(session);
+        }
+    }
+}
+
+void Server::RunJobs()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_jobsMutex);
+            m_jobsReady.wait(lock, [this] { return m_stopping || !m_pendingJobs.empty(); });
+            if (m_stopping)
+            {
+                return;
+            }
+
+            job = std::move(m_pendingJobs.front());
+            m_pendingJobs.pop_front();
+        }
+
+        job.Session->SessionEngine->ReadLine(job.Command);
+
+        {
+            std::lock_guard<std::mutex> lock(m_jobsMutex);
+            m_finishedJobs.push_back(std::move(job.Session));
+        }
+
+        uint64_t count = 1;
+        while (write(m_jobsDoneFd, &count, sizeof(count)) < 0 && errno == EINTR)
+        {
+        }
+    }
+}
+
+void Server::StopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_jobsMutex);
+        m_stopping = true;
+        m_pendingJobs.clear();
+    }
+    m_jobsReady.notify_all();
+
+    // Workers finish the command they're running first
+    for (auto &worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+}
+} // namespace MzingaCpp
+
+#else
+
+namespace MzingaCpp
+{
+struct ServerSession
+{
+};
+
+Server::Server(int numThreads) : m_numThreads(numThreads)
+{
+}
+
+Server::~Server()
+{
+}
+
+bool Server::TryLoadOpeningBook(std::string const &path)
+{
+    m_bookPath = path;
+    return false;
+}
+
+bool Server::Run(std::string const &)
+{
+    return false;
+}
+} // namespace MzingaCpp
+
+#endif
@@ -0,0 +1,139 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#include "Stats.h"
+
+namespace MzingaCpp
+{
+
+static char const *StatCounterNames[(int)StatCounter::NumStatCounters] = {
+    "ValidMoves.QueenBee",
+    "ValidMoves.Spider",
+    "ValidMoves.Beetle",
+    "ValidMoves.Grasshopper",
+    "ValidMoves.SoldierAnt",
+    "ValidMoves.Mosquito",
+    "ValidMoves.Ladybug",
+    "ValidMoves.Pillbug",
+    "IsOneHive",
+    "PlacementCache.Hit",
+    "PlacementCache.Miss",
+    "SlideExpansion",
+    "Allocation",
+    "SetPosition",
+};
+
+char const *GetStatCounterName(StatCounter const &counter)
+{
+    return StatCounterNames[(int)counter];
+}
+
+#ifdef MZINGACPP_STATS
+
+constexpr int MaxStatSlots = 256;
+
+static StatSlot StatSlots[MaxStatSlots];
+
+// Counts of threads that couldn't get a slot, or have since exited
+static std::atomic<uint64_t> SharedCounts[(int)StatCounter::NumStatCounters] = {};
+
+// Totals as of the last reset, so that resetting never writes to another thread's slot
+static std::atomic<uint64_t> ResetCounts[(int)StatCounter::NumStatCounters] = {};
+
+struct StatSlotOwner
+{
+    StatSlot *Slot = nullptr;
+
+    StatSlotOwner()
+    {
+        for (auto &slot : StatSlots)
+        {
+            bool inUse = false;
+            if (slot.InUse.compare_exchange_strong(inUse, true))
+            {
+                Slot = &slot;
+                break;
+            }
+        }
+    }
+
+    ~StatSlotOwner()
+    {
+        if (Slot != nullptr)
+        {
+            // Keep the exiting thread's counts, and free its slot for the next thread
+            for (int i = 0; i < (int)StatCounter::NumStatCounters; i++)
+            {
+                SharedCounts[i].fetch_add(Slot->Counts[i].exchange(0, std::memory_order_relaxed),
+                                          std::memory_order_relaxed);
+            }
+            Slot->InUse.store(false);
+        }
+    }
+};
+
+StatSlot *GetThreadStatSlot()
+{
+    thread_local StatSlotOwner owner;
+    return owner.Slot;
+}
+
+void IncrementSharedStat(StatCounter const &counter)
+{
+    SharedCounts[(int)counter].fetch_add(1, std::memory_order_relaxed);
+}
+
+static void GetTotalStats(StatCounts &result)
+{
+    for (int i = 0; i < (int)StatCounter::NumStatCounters; i++)
+    {
+        result[i] = SharedCounts[i].load(std::memory_order_relaxed);
+    }
+
+    for (auto const &slot : StatSlots)
+    {
+        for (int i = 0; i < (int)StatCounter::NumStatCounters; i++)
+        {
+            result[i] += slot.Counts[i].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void GetStats(StatCounts &result)
+{
+    GetTotalStats(result);
+
+    for (int i = 0; i < (int)StatCounter::NumStatCounters; i++)
+    {
+        result[i] -= ResetCounts[i].load(std::memory_order_relaxed);
+    }
+}
+
+void ResetStats()
+{
+    StatCounts totals;
+    GetTotalStats(totals);
+
+    for (int i = 0; i < (int)StatCounter::NumStatCounters; i++)
+    {
+        ResetCounts[i].store(totals[i], std::memory_order_relaxed);
+    }
+}
+
+#else
+
+void GetStats(StatCounts &result)
+{
+    for (auto &count : result)
+    {
+        count = 0;
+    }
+}
+
+void ResetStats()
+{
+}
+
+#endif
+
+} // namespace MzingaCpp
@@ -0,0 +1,197 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Constants.h"
+#include "Trace.h"
+
+namespace MzingaCpp
+{
+
+std::atomic<bool> TracingEnabled{false};
+
+static auto const TraceEpoch = std::chrono::steady_clock::now();
+
+// A fixed-size ring of the most recent events recorded by one thread at a time
+struct TraceBuffer
+{
+    std::mutex Mutex;
+    std::vector<TraceEvent> Events;
+    size_t NextEvent = 0;
+    bool InUse = false;
+};
+
+static std::mutex TraceBuffersMutex;
+static std::vector<std::unique_ptr<TraceBuffer>> TraceBuffers;
+static int NextTraceThreadId = 0;
+
+// Buffers outlive their threads, so events survive for the dump, and are reused by later threads
+struct TraceBufferOwner
+{
+    TraceBuffer *Buffer = nullptr;
+    int ThreadId;
+
+    TraceBufferOwner()
+    {
+        std::lock_guard<std::mutex> lock(TraceBuffersMutex);
+
+        for (auto &buffer : TraceBuffers)
+        {
+            if (!buffer->InUse)
+            {
+                Buffer = buffer.get();
+                break;
+            }
+        }
+
+        if (Buffer == nullptr)
+        {
+            TraceBuffers.push_back(std::make_unique<TraceBuffer>());
+            Buffer = TraceBuffers.back().get();
+        }
+
+        Buffer->InUse = true;
+        ThreadId = NextTraceThreadId++;
+    }
+
+    ~TraceBufferOwner()
+    {
+        std::lock_guard<std::mutex> lock(TraceBuffersMutex);
+        Buffer->InUse = false;
+    }
+};
+
+void StartTracing()
+{
+    {
+        std::lock_guard<std::mutex> lock(TraceBuffersMutex);
+        for (auto &buffer : TraceBuffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->Mutex);
+            buffer->Events.clear();
+            buffer->NextEvent = 0;
+        }
+    }
+
+    TracingEnabled = true;
+}
+
+void StopTracing()
+{
+    TracingEnabled = false;
+}
+
+int64_t GetTraceTimeNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - TraceEpoch)
+        .count();
+}
+
+void RecordTraceEvent(std::string_view name, char const *argName, int64_t arg, int64_t startNs)
+{
+    int64_t endNs = GetTraceTimeNs();
+
+    thread_local TraceBufferOwner owner;
+    auto buffer = owner.Buffer;
+
+    std::lock_guard<std::mutex> lock(buffer->Mutex);
+
+    if (buffer->Events.size() < TraceBufferSize)
+    {
+        buffer->Events.emplace_back();
+    }
+
+    auto &event = buffer->Events[buffer->NextEvent];
+    buffer->NextEvent = (buffer->NextEvent + 1) % TraceBufferSize;
+
+    auto nameLength = std::min(name.length(), (size_t)MaxTraceNameLength);
+    memcpy(event.Name, name.data(), nameLength);
+    event.Name[nameLength] = '\0';
+    event.ArgName = argName;
+    event.Arg = arg;
+    event.StartNs = startNs;
+    event.DurationNs = endNs - startNs;
+    event.ThreadId = owner.ThreadId;
+}
+
+static void WriteJsonString(std::ostream &output, char const *str)
+{
+    output << '"';
+    for (; *str != '\0'; str++)
+    {
+        if (*str == '"' || *str == '\\')
+        {
+            output << '\\' << *str;
+        }
+        else if ((unsigned char)*str < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)*str);
+            output << escaped;
+        }
+        else
+        {
+            output << *str;
+        }
+    }
+    output << '"';
+}
+
+bool TryDumpTrace(std::string const &path)
+{
+    std::vector<TraceEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(TraceBuffersMutex);
+        for (auto &buffer : TraceBuffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->Mutex);
+            events.insert(events.end(), buffer->Events.begin(), buffer->Events.end());
+        }
+    }
+
+    std::sort(events.begin(), events.end(),
+              [](TraceEvent const &lhs, TraceEvent const &rhs) { return lhs.StartNs < rhs.StartNs; });
+
+    std::ofstream output(path, std::ios::out | std::ios::trunc);
+    if (!output)
+    {
+        return false;
+    }
+
+    // Chrome trace timestamps are in microseconds
+    char time[32];
+
+    output << "{\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        auto const &event = events[i];
+
+        output << (i > 0 ? ",\n" : "\n") << "{\"name\":";
+        WriteJsonString(output, event.Name);
+        snprintf(time, sizeof(time), "%.3f", event.StartNs / 1000.0);
+        output << ",\"ph\":\"X\",\"ts\":" << time;
+        snprintf(time, sizeof(time), "%.3f", event.DurationNs / 1000.0);
+        output << ",\"dur\":" << time << ",\"pid\":1,\"tid\":" << event.ThreadId;
+
+        if (event.ArgName != nullptr)
+        {
+            output << ",\"args\":{";
+            WriteJsonString(output, event.ArgName);
+            output << ':' << event.Arg << '}';
+        }
+
+        output << '}';
+    }
+    output << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return (bool)output;
+}
+
+} // namespace MzingaCpp
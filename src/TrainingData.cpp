@@ -0,0 +1,240 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <random>
+
+#include "Constants.h"
+#include "GameAI.h"
+#include "TrainingData.h"
+
+using namespace MzingaCpp;
+
+TrainingDataWriter::TrainingDataWriter(std::ostream &output) : m_output(output)
+{
+    m_frontBuffer.reserve(TrainingDataBufferSize);
+    m_backBuffer.reserve(TrainingDataBufferSize);
+
+    m_writerThread = std::thread(&TrainingDataWriter::WriteBuffers, this);
+}
+
+TrainingDataWriter::~TrainingDataWriter()
+{
+    Close();
+}
+
+void TrainingDataWriter::Write(std::vector<TrainingRecord> const &records)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_frontBuffer.insert(m_frontBuffer.end(), records.begin(), records.end());
+
+    if (m_frontBuffer.size() >= TrainingDataBufferSize)
+    {
+        // Hand the full buffer to the writer thread, once it's done with the last one
+        m_bufferChanged.wait(lock, [this] { return !m_backBufferFull; });
+
+        m_frontBuffer.swap(m_backBuffer);
+        m_backBufferFull = true;
+        m_bufferChanged.notify_all();
+    }
+}
+
+bool TrainingDataWriter::Close()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (m_closing)
+        {
+            return (bool)m_output;
+        }
+
+        m_bufferChanged.wait(lock, [this] { return !m_backBufferFull; });
+
+        m_frontBuffer.swap(m_backBuffer);
+        m_backBufferFull = !m_backBuffer.empty();
+        m_closing = true;
+        m_bufferChanged.notify_all();
+    }
+
+    m_writerThread.join();
+
+    m_output.flush();
+    return (bool)m_output;
+}
+
+void TrainingDataWriter::WriteBuffers()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        m_bufferChanged.wait(lock, [this] { return m_backBufferFull || m_closing; });
+
+        if (m_backBufferFull)
+        {
+            // Only the writer thread touches a full back buffer, so write it unlocked
+            lock.unlock();
+            m_output.write((char const *)m_backBuffer.data(), m_backBuffer.size() * sizeof(TrainingRecord));
+            lock.lock();
+
+            m_backBuffer.clear();
+            m_backBufferFull = false;
+            m_bufferChanged.notify_all();
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+TrainingDataExporter::TrainingDataExporter(int numThreads, int searchDepth)
+    : m_numThreads(numThreads > 0 ? numThreads : 1), m_searchDepth(searchDepth > 0 ? searchDepth : 1)
+{
+}
+
+long TrainingDataExporter::ExportGames(std::function<bool(std::shared_ptr<Board> &)> const &readNextGame,
+                                       std::ostream &output)
+{
+    return RunThreads(output, [this, &readNextGame](TrainingDataWriter &writer) { ExportGames(readNextGame, writer); });
+}
+
+long TrainingDataExporter::ExportSelfPlay(GameType gameType, int numGames, uint32_t seed, std::ostream &output)
+{
+    m_nextGame = 0;
+    return RunThreads(output, [this, gameType, numGames, seed](TrainingDataWriter &writer) {
+        ExportSelfPlay(gameType, numGames, seed, writer);
+    });
+}
+
+void TrainingDataExporter::ExportGames(std::function<bool(std::shared_ptr<Board> &)> const &readNextGame,
+                                       TrainingDataWriter &writer)
+{
+    GameAI gameAI;
+    std::vector<TrainingRecord> records;
+
+    while (true)
+    {
+        std::shared_ptr<Board> board;
+        {
+            std::lock_guard<std::mutex> lock(m_inputMutex);
+            if (!readNextGame(board))
+            {
+                break;
+            }
+        }
+
+        gameAI.Reset();
+        records.clear();
+
+        // Walk back from the end of the game, searching every position before a move
+        auto result = board->GetBoardState();
+        while (board->TryUndoLastMove())
+        {
+            int score;
+            gameAI.GetBestMove(board, m_searchDepth, std::chrono::milliseconds::zero(), score);
+            records.push_back(GetRecord(board, score));
+        }
+
+        std::reverse(records.begin(), records.end());
+        SetResult(records, result);
+
+        writer.Write(records);
+        m_recordsExported += (long)records.size();
+    }
+}
+
+void TrainingDataExporter::ExportSelfPlay(GameType gameType, int numGames, uint32_t seed, TrainingDataWriter &writer)
+{
+    GameAI gameAI;
+    std::vector<TrainingRecord> records;
+
+    for (int gameIndex = m_nextGame++; gameIndex < numGames; gameIndex = m_nextGame++)
+    {
+        // Seed per game, so the games don't depend on which thread plays them
+        std::mt19937 random(seed + (uint32_t)gameIndex);
+
+        auto board = std::make_shared<Board>(gameType);
+
+        gameAI.Reset();
+        records.clear();
+
+        while (!GameIsOver(board->GetBoardState()) && board->GetCurrentTurn() < MaxSelfPlayTurns)
+        {
+            int score;
+            auto move = gameAI.GetBestMove(board, m_searchDepth, std::chrono::milliseconds::zero(), score);
+            records.push_back(GetRecord(board, score));
+
+            // Random opening moves keep the games from all being the same
+            if (board->GetCurrentTurn() < SelfPlayRandomTurns)
+            {
+                auto validMoves = board->GetValidMoves();
+                auto it = validMoves->begin();
+                std::advance(it, std::uniform_int_distribution<size_t>(0, validMoves->size() - 1)(random));
+                move = *it;
+            }
+
+            board->TrustedPlay(move, "");
+        }
+
+        SetResult(records, board->GetBoardState());
+
+        writer.Write(records);
+        m_recordsExported += (long)records.size();
+    }
+}
+
+TrainingRecord TrainingDataExporter::GetRecord(std::shared_ptr<Board> board, int score)
+{
+    TrainingRecord record;
+
+    for (int pn = 0; pn < (int)PieceName::NumPieceNames; pn++)
+    {
+        auto position = board->GetPosition((PieceName)pn);
+        bool inPlay = position.Stack >= 0;
+        record.PieceQ[pn] = (int8_t)(inPlay ? position.Q : 0);
+        record.PieceR[pn] = (int8_t)(inPlay ? position.R : 0);
+        record.PieceStack[pn] = (int8_t)position.Stack;
+    }
+
+    record.GameType = (int8_t)board->GetGameType();
+    record.CurrentColor = (int8_t)board->GetCurrentColor();
+    record.Result = (int8_t)BoardState::InProgress;
+    record.SearchDepth = (int8_t)m_searchDepth;
+    record.CurrentTurn = (uint16_t)board->GetCurrentTurn();
+    record.Reserved = 0;
+    record.Score = (int32_t)score;
+
+    return record;
+}
+
+void TrainingDataExporter::SetResult(std::vector<TrainingRecord> &records, BoardState const &result)
+{
+    for (auto &record : records)
+    {
+        record.Result = (int8_t)result;
+    }
+}
+
+long TrainingDataExporter::RunThreads(std::ostream &output,
+                                      std::function<void(TrainingDataWriter &)> const &exportThread)
+{
+    m_recordsExported = 0;
+
+    TrainingDataWriter writer(output);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < m_numThreads; i++)
+    {
+        threads.emplace_back(exportThread, std::ref(writer));
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    return writer.Close() ? m_recordsExported.load() : -1;
+}
@@ -1,28 +1,162 @@
 // Copyright (c) Jon Thysell <http://jonthysell.com>
 // Licensed under the MIT License.
 
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
+#include "BatchRunner.h"
+#include "Constants.h"
 #include "Engine.h"
+#include "Server.h"
+#include "Trace.h"
 
-void WriteLine(std::string line)
+void WriteOutput(std::string_view output)
 {
-    std::cout << line << std::endl;
+    std::cout.write(output.data(), output.length());
+    std::cout.flush();
 }
 
 int main(int argc, char *argv[])
 {
-    MzingaCpp::Engine engine{WriteLine};
+    // The engine batches each command's output and flushes it itself
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(nullptr);
 
-    engine.Start();
+    std::string bookPath;
+    std::string batchPath;
+    std::string outputPath;
+    std::string tracePath;
+    std::string socketPath;
+    std::vector<std::string> batchCommands;
+    int numThreads = (int)std::thread::hardware_concurrency();
 
-    std::string line;
-    while (!engine.ExitRequested())
+    for (int i = 1; i < argc; i++)
     {
-        std::getline(std::cin, line);
-        engine.ReadLine(line);
+        if (strcmp(argv[i], "--book") == 0 && i + 1 < argc)
+        {
+            bookPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+        {
+            batchPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+        {
+            outputPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            numThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--command") == 0 && i + 1 < argc)
+        {
+            batchCommands.push_back(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            tracePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--server") == 0 && i + 1 < argc)
+        {
+            socketPath = argv[++i];
+        }
     }
 
-    return 0;
+    if (!tracePath.empty())
+    {
+        if (!MzingaCpp::TracingSupported)
+        {
+            std::cerr << MzingaCpp::ErrorMessage_TracingDisabled << std::endl;
+            return 1;
+        }
+
+        MzingaCpp::StartTracing();
+    }
+
+    int result = 0;
+
+    if (!socketPath.empty())
+    {
+        if (!MzingaCpp::ServerSupported)
+        {
+            std::cerr << MzingaCpp::ErrorMessage_ServerUnsupported << std::endl;
+            return 1;
+        }
+
+        MzingaCpp::Server server{numThreads};
+        if (!bookPath.empty() && !server.TryLoadOpeningBook(bookPath))
+        {
+            std::cerr << "Unable to load opening book " << bookPath << std::endl;
+            return 1;
+        }
+
+        result = server.Run(socketPath) ? 0 : 1;
+    }
+    else if (!batchPath.empty())
+    {
+        std::ifstream input(batchPath);
+        if (!input)
+        {
+            std::cerr << "Unable to open " << batchPath << std::endl;
+            return 1;
+        }
+
+        std::ofstream outputFile;
+        if (!outputPath.empty())
+        {
+            outputFile.open(outputPath, std::ios::binary | std::ios::trunc);
+            if (!outputFile)
+            {
+                std::cerr << "Unable to open " << outputPath << std::endl;
+                return 1;
+            }
+        }
+
+        if (batchCommands.empty())
+        {
+            batchCommands.push_back(MzingaCpp::DefaultBatchCommand);
+        }
+
+        MzingaCpp::BatchRunner batchRunner{numThreads, batchCommands};
+        if (!bookPath.empty() && !batchRunner.TryLoadOpeningBook(bookPath))
+        {
+            std::cerr << "Unable to load opening book " << bookPath << std::endl;
+            return 1;
+        }
+
+        result = batchRunner.Run(input, outputPath.empty() ? std::cout : outputFile) ? 0 : 1;
+    }
+    else
+    {
+        MzingaCpp::Engine engine{WriteOutput};
+
+        if (!bookPath.empty() && !engine.TryLoadOpeningBook(bookPath))
+        {
+            std::cerr << "Unable to load opening book " << bookPath << std::endl;
+            return 1;
+        }
+
+        engine.Start();
+
+        std::string line;
+        while (!engine.ExitRequested())
+        {
+            std::getline(std::cin, line);
+            engine.ReadLine(line);
+        }
+    }
+
+    if (!tracePath.empty() && !MzingaCpp::TryDumpTrace(tracePath))
+    {
+        std::cerr << "Unable to write trace " << tracePath << std::endl;
+        return 1;
+    }
+
+    return result;
 }
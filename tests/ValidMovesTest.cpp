@@ -0,0 +1,137 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+
+using namespace MzingaCpp;
+
+constexpr int GamesPerGameType = 4;
+constexpr int MaxTurnsPerGame = 60;
+constexpr int MaxCandidateStack = 4;
+constexpr int MaxReportedMismatches = 10;
+
+// Every cell in or next to the hive, which covers every destination a valid move can have, plus plenty that no
+// move can reach
+std::vector<int> GetCandidateCells(Board const &board)
+{
+    std::vector<int> cells;
+    for (int pn = 0; pn < (int)PieceName::NumPieceNames; pn++)
+    {
+        auto pieceName = (PieceName)pn;
+        if (!board.PieceInPlay(pieceName))
+        {
+            continue;
+        }
+
+        int cell = GetCell(board.GetPosition(pieceName));
+        cells.push_back(cell);
+        for (int dir = 0; dir < (int)Direction::NumDirections; dir++)
+        {
+            cells.push_back(GetNeighborCell(cell, (Direction)dir));
+        }
+    }
+
+    if (cells.empty())
+    {
+        cells.push_back(OriginCell);
+    }
+
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+    return cells;
+}
+
+// Compares IsValidMove against full move generation for every piece moving to every candidate destination, from
+// both its real source and a wrong one, returning the number of mismatches
+long CheckPosition(Board const &board, long &candidatesChecked)
+{
+    auto validMoves = board.GetValidMoves();
+    auto cells = GetCandidateCells(board);
+
+    long mismatches = 0;
+    auto check = [&](Move const &move) {
+        candidatesChecked++;
+        bool expected = validMoves->count(move) > 0;
+        if (board.IsValidMove(move) != expected)
+        {
+            if (++mismatches <= MaxReportedMismatches)
+            {
+                std::string moveString;
+                board.TryGetMoveString(move, moveString);
+                std::cerr << "Mismatch for " << moveString << " (expected " << (expected ? "valid" : "invalid")
+                          << ") in " << board.GetGameString() << std::endl;
+            }
+        }
+    };
+
+    check(PassMove);
+
+    for (int pn = 0; pn < (int)PieceName::NumPieceNames; pn++)
+    {
+        auto pieceName = (PieceName)pn;
+        auto source = board.GetPosition(pieceName);
+        auto wrongSource = board.PieceInPlay(pieceName) ? NullPosition : OriginPosition;
+
+        for (int cell : cells)
+        {
+            for (int stack = 0; stack < MaxCandidateStack; stack++)
+            {
+                auto destination = GetCellPosition(cell, stack);
+                check(Move{pieceName, source, destination});
+                check(Move{pieceName, wrongSource, destination});
+            }
+        }
+    }
+
+    for (auto const &move : *validMoves)
+    {
+        check(move);
+    }
+
+    return mismatches;
+}
+
+// Replays seeded random games of every game type, checking that Board::IsValidMove agrees with
+// Board::GetValidMoves for every candidate move in every position reached
+int main()
+{
+    std::mt19937 random(12345);
+
+    long positionsChecked = 0;
+    long candidatesChecked = 0;
+    long mismatches = 0;
+
+    for (int gt = 0; gt < NumGameTypes; gt++)
+    {
+        for (int game = 0; game < GamesPerGameType; game++)
+        {
+            Board board((GameType)gt);
+            for (int turn = 0; turn < MaxTurnsPerGame && GameInProgress(board.GetBoardState()); turn++)
+            {
+                mismatches += CheckPosition(board, candidatesChecked);
+                positionsChecked++;
+
+                auto validMoves = board.GetValidMoves();
+                auto randomMove = validMoves->begin();
+                std::advance(randomMove, std::uniform_int_distribution<size_t>(0, validMoves->size() - 1)(random));
+
+                // Keep the move strings, so that mismatches can be reported with a replayable game string
+                std::string moveString;
+                board.TryGetMoveString(*randomMove, moveString);
+                board.TrustedPlay(*randomMove, moveString);
+            }
+        }
+    }
+
+    std::cout << "Checked " << candidatesChecked << " candidate moves in " << positionsChecked << " positions, "
+              << mismatches << " mismatches" << std::endl;
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,376 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+
+using namespace MzingaCpp;
+
+constexpr int DefaultRuns = 5;
+constexpr double DefaultThreshold = 10.0;
+
+constexpr int PerftDepth = 3;
+constexpr int ValidMovesIterations = 200;
+
+// One midgame position per GameType, for perft
+static char const *PerftGameStrings[] = {
+    "Base;InProgress;White[9];wB1;bA1 /wB1;wB2 wB1/;bQ -bA1;wA1 -wB2;bQ /bA1;wQ wB2/;bQ bA1\\;wA2 \\wQ;bA2 /bA1;wA2 "
+    "wB2\\;bA2 \\wQ;wS1 wQ-;bA2 wS1\\;wA1 bQ\\;bA2 /wA1",
+    "Base+M;InProgress;White[9];wB1;bA1 wB1\\;wG1 wB1/;bA2 /bA1;wG2 wG1/;bG1 bA1-;wQ \\wG2;bQ bG1\\;wB2 -wB1;bA2 "
+    "bG1/;wM -wB2;bS1 bA2\\;wA1 \\wB2;bM /bA1;wM bM\\;bB1 bS1-",
+    "Base+L;InProgress;White[9];wS1;bG1 /wS1;wG1 wS1/;bL /bG1;wG2 wG1-;bB1 /bL;wQ \\wG2;bQ bB1\\;wL wQ/;bA1 /bB1;wG3 "
+    "-wL;bA1 wL-;wA1 wG1\\;bA2 -bG1;wB1 -wG1;bA1 /bA2",
+    "Base+P;InProgress;White[9];wS1;bG1 /wS1;wG1 wS1/;bP /bG1;wG2 wG1/;bB1 /bP;wQ -wG2;bQ bB1\\;wP \\wG2;bA1 /bB1;wA1 "
+    "wP/;bA1 wA1-;wB1 -wA1;bA1 \\wA1;wA2 wG1\\;bA1 /wQ",
+    "Base+ML;InProgress;White[9];wA1;bB1 wA1\\;wS1 wA1/;bG1 bB1\\;wL wS1/;bM /bG1;wQ -wL;bQ /bB1;wL -wA1;bS1 bM\\;wL "
+    "wS1/;bL bS1\\;wB1 -wQ;bG2 bG1\\;wL -wA1;bG1 -bQ",
+    "Base+MP;InProgress;White[9];wA1;bB1 \\wA1;wS1 wA1-;bG1 -bB1;wP wS1/;bM -bG1;wQ wP\\;bQ bB1/;wM wQ-;bQ -wP;wA1 "
+    "wP/;bP \\bG1;wS2 wM/;bP -bM;wG1 wM\\;bB2 \\bP",
+    "Base+LP;InProgress;White[9];wA1;bB1 wA1\\;wS1 wA1/;bG1 bB1\\;wP wS1/;bL /bG1;wQ -wP;bQ /bB1;wQ wP\\;bS1 /bL;wB1 "
+    "-wP;bP /bS1;wB1 \\wP;bS2 bP\\;wL /wB1;bA1 bG1\\",
+    "Base+MLP;InProgress;White[9];wL;bB1 -wL;wQ wL\\;bL /bB1;wS1 wL/;bP -bB1;wM wS1/;bQ \\bP;wA1 wQ\\;bA1 \\bB1;wA1 "
+    "\\bA1;bM -bQ;wA1 wS1\\;bL -wS1;wL \\bA1;bG1 bP\\",
+};
+
+// Later midgame positions, which validmoves runs on along with the perft positions
+static char const *ValidMovesGameStrings[] = {
+    "Base;InProgress;White[14];wG1;bS1 \\wG1;wB1 wG1\\;bS2 \\bS1;wA1 wB1-;bB1 bS2/;wQ wA1\\;bQ bB1-;wA2 wA1/;bA1 "
+    "\\bB1;wB2 /wG1;bA1 \\wA2;wA3 wB1\\;bA1 bB1\\;wA2 /wB2;bA1 \\wA1;wA2 /bS1;bA2 bQ/;wA3 /wQ;bA1 wQ/;wA2 wB1\\;bG1 "
+    "bQ\\;wA1 bG1-;bB2 -bB1;wA3 bA1/;bA2 /bB2",
+    "Base+M;InProgress;White[14];wS1;bM /wS1;wM \\wS1;bS1 bM\\;wB1 wS1/;bB1 /bM;wQ -wM;bQ -bB1;wS2 wB1/;bG1 bQ\\;wB2 "
+    "-wS2;bS2 /bG1;wA1 wS2-;bS1 wS2\\;wG1 wA1/;bS2 bM\\;wG2 \\wG1;bG2 -bM;wG3 -wG2;bB1 bG2;wB1 bS1;bA1 bB1\\;wA2 "
+    "\\wG3;bB2 -bQ;wA2 /wB1;bB1 wQ\\",
+    "Base+L;InProgress;White[14];wS1;bL /wS1;wL \\wS1;bS1 bL\\;wB1 wS1/;bB1 /bL;wQ -wL;bQ -bB1;wS2 wB1/;bG1 bQ\\;wB2 "
+    "-wS2;bS2 /bG1;wA1 wS2-;bS1 wS2\\;wG1 wA1/;bS2 bL\\;wG2 \\wG1;bG2 -bL;wG3 -wG2;bB1 bG2;wB1 bS1;bA1 bB1\\;wA2 "
+    "\\wG3;bB2 -bQ;wA2 /wB1;bB1 wQ\\",
+    "Base+P;InProgress;White[14];wS1;bP /wS1;wA1 wS1-;bS1 bP\\;wA2 wA1/;bB1 /bP;wQ wA2-;bQ -bB1;wA3 wA2\\;bG1 bS1\\;"
+    "wA2 bB1\\;bA1 -bQ;wS2 \\wA1;bS1 -wS1;wG1 \\wQ;bB2 -bS1;wS2 \\bB2;bG2 -bA1;wG2 \\wA1;bA2 bG1-;wB1 /wA2;bG3 bA2/;"
+    "wG3 \\wG1;bS2 -bG3;wG2 bQ\\;bA3 bB2\\",
+    "Base+ML;InProgress;White[14];wA1;bB1 wA1\\;wS1 wA1/;bG1 bB1\\;wL wS1/;bM /bG1;wQ -wL;bQ /bB1;wL -wA1;bS1 bM\\;wL "
+    "wS1/;bL bS1\\;wB1 -wQ;bG2 bG1\\;wL -wA1;bG1 -bQ;wS2 wS1-;bB2 /bM;wM wS2/;bL bG2-;wA2 wM\\;bA1 /bG1;wB2 -wL;bA1 "
+    "/bB2;wG1 -wB1;bG3 bB2\\",
+    "Base+MP;InProgress;White[14];wA1;bB1 \\wA1;wS1 wA1-;bG1 -bB1;wP wS1/;bM -bG1;wQ wP\\;bQ bB1/;wM wQ-;bQ -wP;wA1 "
+    "wP/;bP \\bG1;wS2 wM/;bP -bM;wG1 wM\\;bB2 \\bP;wA2 wG1-;bS1 bM\\;wA3 wA1\\;bA1 bB2/;wA2 wS2-;bA1 /bP;wA2 bS1\\;bA2 "
+    "-bA1;wA1 \\wP;bA3 \\bB1",
+    "Base+LP;InProgress;White[14];wA1;bB1 wA1\\;wS1 wA1/;bG1 bB1\\;wP wS1/;bL /bG1;wQ -wP;bQ /bB1;wQ wP\\;bS1 /bL;wB1 "
+    "-wP;bP /bS1;wB1 \\wP;bS2 bP\\;wL /wB1;bA1 bG1\\;wB2 wQ/;bG2 bA1/;wL /wA1;bG3 /bQ;wA2 -wB1;bB2 bS1\\;wG1 -wS1;bL "
+    "\\bG2;wL -wG1;bA2 /bS2",
+    "Base+MLP;InProgress;White[14];wL;bB1 -wL;wQ wL\\;bL /bB1;wS1 wL/;bP -bB1;wM wS1/;bQ \\bP;wA1 wQ\\;bA1 \\bB1;wA1 "
+    "\\bA1;bM -bQ;wA1 wS1\\;bL -wS1;wL \\bA1;bG1 bP\\;wP wA1\\;bB1 bL;wB1 wP/;bS1 bG1\\;wQ bB1\\;bS1 /wP;wL -bM;bA2 "
+    "/bP;wG1 -wL;bA3 bA2\\",
+};
+
+struct BenchmarkResult
+{
+    std::string Name;
+    std::string Unit;
+    double Median = 0.0;
+    double Variance = 0.0;
+    long Nodes = 0;
+};
+
+BenchmarkResult Summarize(std::string const &name, std::string const &unit, std::vector<double> samples, long nodes)
+{
+    BenchmarkResult result{name, unit};
+    result.Nodes = nodes;
+
+    std::sort(samples.begin(), samples.end());
+    size_t mid = samples.size() / 2;
+    result.Median = samples.size() % 2 == 1 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2.0;
+
+    double mean = 0.0;
+    for (auto const &sample : samples)
+    {
+        mean += sample;
+    }
+    mean /= samples.size();
+
+    for (auto const &sample : samples)
+    {
+        result.Variance += (sample - mean) * (sample - mean);
+    }
+    result.Variance /= samples.size() > 1 ? samples.size() - 1 : 1;
+
+    return result;
+}
+
+bool TryRunSuite(int runs, std::vector<BenchmarkResult> &results)
+{
+    std::vector<std::shared_ptr<Board>> perftBoards;
+    std::vector<std::shared_ptr<Board>> validMovesBoards;
+
+    for (auto const &gameString : PerftGameStrings)
+    {
+        std::shared_ptr<Board> board;
+        if (!Board::TryParseGameString(gameString, board))
+        {
+            std::cerr << "Unable to load " << gameString << std::endl;
+            return false;
+        }
+        perftBoards.push_back(board);
+        validMovesBoards.push_back(board);
+    }
+
+    for (auto const &gameString : ValidMovesGameStrings)
+    {
+        std::shared_ptr<Board> board;
+        if (!Board::TryParseGameString(gameString, board))
+        {
+            std::cerr << "Unable to load " << gameString << std::endl;
+            return false;
+        }
+        validMovesBoards.push_back(board);
+    }
+
+    for (auto const &board : perftBoards)
+    {
+        std::vector<double> samples;
+        long nodes = 0;
+
+        for (int run = 0; run < runs; run++)
+        {
+            auto startTime = std::chrono::steady_clock::now();
+            nodes = board->CalculatePerft(PerftDepth);
+            auto endTime = std::chrono::steady_clock::now();
+
+            samples.push_back(std::chrono::duration<double, std::milli>(endTime - startTime).count());
+        }
+
+        auto name = "perft(" + std::to_string(PerftDepth) + ")." + GetEnumString(board->GetGameType());
+        results.push_back(Summarize(name, "ms", samples, nodes));
+    }
+
+    std::vector<double> samples;
+    std::string moveStrings;
+    for (int run = 0; run < runs; run++)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        for (int i = 0; i < ValidMovesIterations; i++)
+        {
+            for (auto const &board : validMovesBoards)
+            {
+                board->GetMoveStrings(*(board->GetValidMoves()), moveStrings);
+            }
+        }
+        auto endTime = std::chrono::steady_clock::now();
+
+        samples.push_back(std::chrono::duration<double, std::micro>(endTime - startTime).count() /
+                          (ValidMovesIterations * validMovesBoards.size()));
+    }
+
+    results.push_back(Summarize("validmoves", "us", samples, 0));
+
+    return true;
+}
+
+bool TryWriteResults(std::string const &path, std::vector<BenchmarkResult> const &results)
+{
+    std::ofstream output(path, std::ios::out | std::ios::trunc);
+    if (!output)
+    {
+        return false;
+    }
+
+    output << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        auto const &result = results[i];
+        output << "    {\"name\": \"" << result.Name << "\", \"unit\": \"" << result.Unit
+               << "\", \"median\": " << result.Median << ", \"variance\": " << result.Variance
+               << ", \"nodes\": " << result.Nodes << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    output << "  ]\n}\n";
+
+    return (bool)output;
+}
+
+// Reads the value after "key": within str, as written by TryWriteResults
+bool TryReadJsonValue(std::string const &str, std::string const &key, std::string &result)
+{
+    auto keyStart = str.find("\"" + key + "\"");
+    if (keyStart == std::string::npos)
+    {
+        return false;
+    }
+
+    auto valueStart = str.find_first_not_of(" :", keyStart + key.length() + 2);
+    if (valueStart == std::string::npos)
+    {
+        return false;
+    }
+
+    if (str[valueStart] == '"')
+    {
+        auto valueEnd = str.find('"', valueStart + 1);
+        result = str.substr(valueStart + 1, valueEnd - valueStart - 1);
+    }
+    else
+    {
+        auto valueEnd = str.find_first_of(",}", valueStart);
+        result = str.substr(valueStart, valueEnd - valueStart);
+    }
+
+    return true;
+}
+
+bool TryReadResults(std::string const &path, std::map<std::string, BenchmarkResult> &results)
+{
+    std::ifstream input(path);
+    if (!input)
+    {
+        return false;
+    }
+
+    std::stringstream ss;
+    ss << input.rdbuf();
+    auto json = ss.str();
+
+    // Every benchmark is a flat object, so walk them brace by brace
+    for (auto start = json.find('{', json.find('[')); start != std::string::npos; start = json.find('{', start + 1))
+    {
+        auto object = json.substr(start, json.find('}', start) - start + 1);
+
+        BenchmarkResult result;
+        std::string median, variance, nodes;
+        if (!TryReadJsonValue(object, "name", result.Name) || !TryReadJsonValue(object, "median", median))
+        {
+            return false;
+        }
+
+        result.Median = atof(median.c_str());
+        if (TryReadJsonValue(object, "variance", variance))
+        {
+            result.Variance = atof(variance.c_str());
+        }
+        if (TryReadJsonValue(object, "nodes", nodes))
+        {
+            result.Nodes = atol(nodes.c_str());
+        }
+
+        results[result.Name] = result;
+    }
+
+    return true;
+}
+
+// Runs a fixed suite of perft and validmoves benchmarks, optionally comparing the
+// medians against a baseline and failing if any regressed by more than a threshold
+int main(int argc, char *argv[])
+{
+    int runs = DefaultRuns;
+    double threshold = DefaultThreshold;
+    std::string baselinePath;
+    std::string savePath;
+    bool writeBaseline = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+        {
+            runs = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+        {
+            threshold = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+        {
+            baselinePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc)
+        {
+            savePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--write-baseline") == 0)
+        {
+            writeBaseline = true;
+        }
+        else
+        {
+            std::cerr << "Usage: mzingacpp-bench [--runs <runs>] [--baseline <baseline.json> [--write-baseline]] "
+                         "[--threshold <percent>] [--save <results.json>]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<BenchmarkResult> results;
+    if (!TryRunSuite(runs, results))
+    {
+        return 1;
+    }
+
+    std::map<std::string, BenchmarkResult> baseline;
+    if (!baselinePath.empty() && !TryReadResults(baselinePath, baseline))
+    {
+        // A missing baseline must not pass as a comparison, unless asked to start one
+        if (!writeBaseline)
+        {
+            std::cerr << "Unable to read baseline " << baselinePath << std::endl;
+            return 1;
+        }
+
+        if (!TryWriteResults(baselinePath, results))
+        {
+            std::cerr << "Unable to write " << baselinePath << std::endl;
+            return 1;
+        }
+
+        std::cout << "No baseline at " << baselinePath << ", wrote these results as the baseline" << std::endl;
+    }
+
+    int regressions = 0;
+
+    for (auto const &result : results)
+    {
+        std::cout << result.Name << ": median " << result.Median << " " << result.Unit << ", variance "
+                  << result.Variance;
+
+        auto it = baseline.find(result.Name);
+        if (it != baseline.end())
+        {
+            auto const &base = it->second;
+            double change = base.Median > 0.0 ? 100.0 * (result.Median - base.Median) / base.Median : 0.0;
+            std::cout << ", baseline " << base.Median << " " << result.Unit << " (" << (change >= 0.0 ? "+" : "")
+                      << change << "%)";
+
+            if (base.Nodes != result.Nodes)
+            {
+                // Different node counts mean move generation changed, not just its speed
+                std::cout << " FAILED: " << result.Nodes << " nodes, expected " << base.Nodes;
+                regressions++;
+            }
+            else if (change > threshold)
+            {
+                std::cout << " REGRESSED";
+                regressions++;
+            }
+        }
+
+        std::cout << std::endl;
+    }
+
+    if (!savePath.empty() && !TryWriteResults(savePath, results))
+    {
+        std::cerr << "Unable to write " << savePath << std::endl;
+        return 1;
+    }
+
+    if (regressions > 0)
+    {
+        std::cout << regressions << " benchmark(s) regressed by more than " << threshold << "%" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
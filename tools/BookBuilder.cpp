@@ -0,0 +1,102 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "Board.h"
+#include "Constants.h"
+#include "OpeningBook.h"
+
+using namespace MzingaCpp;
+
+// Compiles a list of UHP game strings (one per line) into an opening book
+// of the positions within the first MaxOpeningBookTurns turns of each game
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: mzingacpp-bookbuilder <games.txt> <output.book>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream input(argv[1]);
+    if (!input)
+    {
+        std::cerr << "Unable to open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    // (key, packed move) => weight
+    std::map<std::pair<uint64_t, uint32_t>, uint32_t> weights;
+
+    int gamesRead = 0;
+    int gamesSkipped = 0;
+
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+
+        if (line.empty())
+        {
+            continue;
+        }
+
+        // Load games exactly as the engine's newgame would, so only games it accepts are used
+        std::shared_ptr<Board> board;
+        if (!Board::TryParseGameString(line, board))
+        {
+            gamesSkipped++;
+            continue;
+        }
+
+        while (board->GetCurrentTurn() > MaxOpeningBookTurns)
+        {
+            board->TryUndoLastMove();
+        }
+
+        // Walk back through the opening, weighting each move by the position it was played from
+        while (board->GetCurrentTurn() > 0)
+        {
+            auto move = board->GetLastMove();
+            board->TryUndoLastMove();
+
+            if (move != PassMove)
+            {
+                uint32_t packedMove = ((uint32_t)move.PieceName << 24) | ((uint32_t)(move.Destination.Q & 0xFF) << 16) |
+                                      ((uint32_t)(move.Destination.R & 0xFF) << 8) |
+                                      (uint32_t)(move.Destination.Stack & 0xFF);
+                weights[std::make_pair(board->GetZobristKey(), packedMove)]++;
+            }
+        }
+
+        gamesRead++;
+    }
+
+    std::vector<OpeningBookEntry> entries;
+    entries.reserve(weights.size());
+    for (auto const &iter : weights)
+    {
+        uint32_t packedMove = iter.first.second;
+        entries.push_back(OpeningBookEntry{iter.first.first, iter.second, (int8_t)(packedMove >> 24),
+                                           (int8_t)(packedMove >> 16), (int8_t)(packedMove >> 8), (int8_t)packedMove});
+    }
+
+    if (!OpeningBook::TryWrite(argv[2], entries))
+    {
+        std::cerr << "Unable to write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Read " << gamesRead << " games (" << gamesSkipped << " skipped), wrote " << entries.size()
+              << " entries to " << argv[2] << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "GameRecord.h"
+
+using namespace MzingaCpp;
+
+// Converts a list of UHP game strings (one per line) to binary game records,
+// and back again
+int main(int argc, char *argv[])
+{
+    if (argc < 4 || (strcmp(argv[1], "pack") != 0 && strcmp(argv[1], "unpack") != 0))
+    {
+        std::cerr << "Usage: mzingacpp-gamerecord pack <games.txt> <games.mzgr>" << std::endl;
+        std::cerr << "       mzingacpp-gamerecord unpack <games.mzgr> <games.txt>" << std::endl;
+        return 1;
+    }
+
+    bool pack = strcmp(argv[1], "pack") == 0;
+
+    std::ifstream input(argv[2], pack ? std::ios::in : std::ios::in | std::ios::binary);
+    if (!input)
+    {
+        std::cerr << "Unable to open " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::ofstream output(argv[3], pack ? std::ios::out | std::ios::binary | std::ios::trunc
+                                       : std::ios::out | std::ios::trunc);
+    if (!output)
+    {
+        std::cerr << "Unable to open " << argv[3] << std::endl;
+        return 1;
+    }
+
+    int gamesConverted = 0;
+    int gamesSkipped = 0;
+
+    if (pack)
+    {
+        GameRecordWriter writer(output);
+
+        std::string line;
+        while (std::getline(input, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+
+            if (line.empty())
+            {
+                continue;
+            }
+
+            if (writer.TryWrite(line))
+            {
+                gamesConverted++;
+            }
+            else
+            {
+                gamesSkipped++;
+            }
+        }
+    }
+    else
+    {
+        GameRecordReader reader(input);
+
+        std::shared_ptr<Board> board;
+        while (reader.TryReadNext(board))
+        {
+            output << board->GetGameString() << '\n';
+            gamesConverted++;
+        }
+
+        // A clean end of input leaves nothing partially read
+        if (!input.eof() || input.gcount() != 0)
+        {
+            std::cerr << "Unable to read game record " << gamesConverted + 1 << std::endl;
+            return 1;
+        }
+    }
+
+    if (!output)
+    {
+        std::cerr << "Unable to write " << argv[3] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Converted " << gamesConverted << " games, skipped " << gamesSkipped << std::endl;
+
+    return 0;
+}
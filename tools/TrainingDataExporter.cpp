@@ -0,0 +1,151 @@
+// Copyright (c) Jon Thysell <http://jonthysell.com>
+// Licensed under the MIT License.
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "Constants.h"
+#include "GameRecord.h"
+#include "TrainingData.h"
+
+using namespace MzingaCpp;
+
+void WriteUsage()
+{
+    std::cerr << "Usage: mzingacpp-trainingdata games <games.txt> <output.bin> [options]" << std::endl;
+    std::cerr << "       mzingacpp-trainingdata records <games.mzgr> <output.bin> [options]" << std::endl;
+    std::cerr << "       mzingacpp-trainingdata selfplay <gametype> <numgames> <output.bin> [options]" << std::endl;
+    std::cerr << "Options: --depth <depth> --threads <threads> --seed <seed>" << std::endl;
+}
+
+// Searches every position of a list of UHP game strings (one per line), a file
+// of game records or self-play games, and writes a TrainingRecord for each
+int main(int argc, char *argv[])
+{
+    bool selfPlay = argc >= 2 && strcmp(argv[1], "selfplay") == 0;
+    int firstOption = selfPlay ? 5 : 4;
+
+    if (argc < firstOption ||
+        (!selfPlay && strcmp(argv[1], "games") != 0 && strcmp(argv[1], "records") != 0))
+    {
+        WriteUsage();
+        return 1;
+    }
+
+    int searchDepth = DefaultMaxSearchDepth;
+    int numThreads = (int)std::thread::hardware_concurrency();
+    uint32_t seed = 0;
+
+    for (int i = firstOption; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc)
+        {
+            searchDepth = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            numThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            WriteUsage();
+            return 1;
+        }
+    }
+
+    char const *outputPath = argv[firstOption - 1];
+    std::ofstream output(outputPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!output)
+    {
+        std::cerr << "Unable to open " << outputPath << std::endl;
+        return 1;
+    }
+
+    TrainingDataExporter exporter{numThreads, searchDepth};
+
+    long recordsExported;
+    int gamesSkipped = 0;
+
+    if (selfPlay)
+    {
+        auto gameType = GetGameTypeValue(argv[2]);
+        int numGames = atoi(argv[3]);
+        if (gameType == GameType::INVALID || numGames <= 0)
+        {
+            WriteUsage();
+            return 1;
+        }
+
+        recordsExported = exporter.ExportSelfPlay(gameType, numGames, seed, output);
+    }
+    else
+    {
+        bool records = strcmp(argv[1], "records") == 0;
+
+        std::ifstream input(argv[2], records ? std::ios::in | std::ios::binary : std::ios::in);
+        if (!input)
+        {
+            std::cerr << "Unable to open " << argv[2] << std::endl;
+            return 1;
+        }
+
+        if (records)
+        {
+            GameRecordReader reader(input);
+            recordsExported =
+                exporter.ExportGames([&reader](std::shared_ptr<Board> &board) { return reader.TryReadNext(board); },
+                                     output);
+        }
+        else
+        {
+            std::string line;
+            recordsExported = exporter.ExportGames(
+                [&input, &line, &gamesSkipped](std::shared_ptr<Board> &board) {
+                    while (std::getline(input, line))
+                    {
+                        if (!line.empty() && line.back() == '\r')
+                        {
+                            line.pop_back();
+                        }
+
+                        if (line.empty())
+                        {
+                            continue;
+                        }
+
+                        if (Board::TryParseGameString(line, board))
+                        {
+                            return true;
+                        }
+
+                        gamesSkipped++;
+                    }
+                    return false;
+                },
+                output);
+        }
+    }
+
+    if (recordsExported < 0)
+    {
+        std::cerr << "Unable to write " << outputPath << std::endl;
+        return 1;
+    }
+
+    std::cout << "Exported " << recordsExported << " positions";
+    if (!selfPlay)
+    {
+        std::cout << ", skipped " << gamesSkipped << " games";
+    }
+    std::cout << std::endl;
+
+    return 0;
+}